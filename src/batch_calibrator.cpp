@@ -0,0 +1,187 @@
+#include "batch_calibrator.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include "frame_loader.hpp"
+
+
+/**
+ * @brief Construct a new BatchCalibrator object
+ * @param board Chessboard model shared by all datasets
+ * @param output_dir Directory for the per-dataset calibration files and the summary report
+ * @param targets Uncertainty targets reported per dataset
+ */
+BatchCalibrator::BatchCalibrator(const Chessboard& board, const std::string& output_dir, const ConvergenceTargets& targets)
+    : processor_(board, false), output_dir_(output_dir), targets_(targets) {}
+
+/**
+ * @brief Add a dataset to the batch
+ * @param directory Directory of still frames
+ * @return true if the directory contains at least one image file
+ */
+bool BatchCalibrator::add_dataset(const std::string& directory) {
+    ImageSequenceLoader loader(directory);
+
+    Dataset dataset;
+    dataset.files = loader.get_filenames();
+    dataset.results.resize(dataset.files.size());
+    dataset.image_size = loader.get_frame_size();
+
+    DatasetReport report;
+    report.directory = directory;
+    report.frames = (int)dataset.files.size();
+
+    datasets_.push_back(std::move(dataset));
+    reports_.push_back(report);
+    return loader.is_opened();
+}
+
+/**
+ * @brief Detect on all datasets, calibrate each, and save the calibration files
+ *
+ * The work list takes the first frame of every dataset, then the second frame of every dataset, and so on,
+ * so no dataset monopolizes the pool. Detection runs on a work-stealing scheduler: frames differ a lot in cost,
+ * and idle threads steal frames, and the pose candidates of slow frames, instead of idling behind a static chunk
+ * @param budget Thread budget whose pool runs the detection
+ * @return Number of datasets calibrated successfully
+ */
+size_t BatchCalibrator::run(ThreadBudget& budget) {
+    std::error_code ec;
+    std::filesystem::create_directories(output_dir_, ec);
+
+    // Interleave the frames of all datasets
+    std::vector<std::pair<size_t, size_t>> jobs;
+    size_t longest = 0;
+    for (const auto& dataset : datasets_) {
+        longest = std::max(longest, dataset.files.size());
+    }
+    for (size_t f = 0; f < longest; ++f) {
+        for (size_t d = 0; d < datasets_.size(); ++d) {
+            if (f < datasets_[d].files.size()) {
+                jobs.emplace_back(d, f);
+            }
+        }
+    }
+
+    // Detection and pose of every frame, each result goes to its own slot. With the whole work list
+    // queued, frames run concurrently and OpenCV runs each call on its calling thread
+    budget.rebalance(jobs.size());
+    TaskScheduler& scheduler = budget.get_scheduler();
+    processor_.set_scheduler(&scheduler);
+    scheduler.parallel_for(0, (int)jobs.size(), [&](int j) {
+        Dataset& dataset = datasets_[jobs[j].first];
+        size_t f = jobs[j].second;
+
+        cv::Mat frame = cv::imread(dataset.files[f]);
+        if (!frame.empty()) {
+            dataset.results[f] = processor_.process(frame);
+        }
+    });
+    processor_.set_scheduler(nullptr);
+
+    // Calibrate the datasets concurrently, on OpenCV's pool, which gets the whole budget
+    budget.rebalance(1);
+    cv::parallel_for_(cv::Range(0, (int)datasets_.size()), [&](const cv::Range& range) {
+        for (int d = range.start; d < range.end; ++d) {
+            calibrate_dataset((size_t)d);
+        }
+    }, (double)datasets_.size());
+
+    return (size_t)std::count_if(reports_.begin(), reports_.end(), [](const DatasetReport& r) { return r.calibrated; });
+}
+
+/**
+ * @brief Calibrate one dataset from its accepted frames in file order
+ *
+ * All accepted frames are used; early stopping would need a calibration after every sample and
+ * is only reported here, as whether the final intrinsics meet the targets
+ * @param index Index of the dataset
+ */
+void BatchCalibrator::calibrate_dataset(size_t index) {
+    const Dataset& dataset = datasets_[index];
+    DatasetReport& report = reports_[index];
+
+    Calibrator calibrator;
+    auto obj_pts = processor_.get_board().generate_object_points();
+    for (const auto& result : dataset.results) {
+        if (result.accepted()) {
+            calibrator.add_sample(result.corners, obj_pts);
+        }
+    }
+    report.accepted = (int)calibrator.get_num_samples();
+
+    if (report.accepted == 0 || !calibrator.calibrate(dataset.image_size)) {
+        return;
+    }
+
+    std::string name = std::filesystem::path(report.directory).filename().string();
+    if (name.empty()) {
+        name = std::filesystem::path(report.directory).parent_path().filename().string();
+    }
+    char prefix[32];
+    std::snprintf(prefix, sizeof(prefix), "calibration_%03zu_", index);
+    report.calibration_file = (std::filesystem::path(output_dir_) / (prefix + name + ".yml")).string();
+
+    calibrator.save(report.calibration_file);
+    report.calibrated = true;
+    report.converged = calibrator.has_converged(targets_);
+    report.reproj_error = calibrator.get_reproj_error();
+}
+
+/**
+ * @brief Save the summary of all datasets
+ * @param filename Output filename, YAML or XML supported by OpenCV
+ */
+void BatchCalibrator::save_report(const std::string& filename) const {
+    cv::FileStorage fs(filename, cv::FileStorage::WRITE);
+    fs << "datasetCount" << (int)reports_.size();
+    fs << "datasets" << "[";
+    for (const auto& report : reports_) {
+        fs << "{";
+        fs << "directory" << report.directory;
+        fs << "calibrationFile" << report.calibration_file;
+        fs << "frames" << report.frames;
+        fs << "accepted" << report.accepted;
+        fs << "calibrated" << (int)report.calibrated;
+        fs << "converged" << (int)report.converged;
+        fs << "reprojError" << report.reproj_error;
+        fs << "}";
+    }
+    fs << "]";
+    fs.release();
+}
+
+/**
+ * @brief Get the outcome of every dataset, in the order they were added
+ * @return Per-dataset reports
+ */
+const std::vector<DatasetReport>& BatchCalibrator::get_reports() const {
+    return reports_;
+}
+
+/**
+ * @brief Read a dataset list, one directory per line, blank lines and lines starting with # ignored
+ * @param filename List file
+ * @return Dataset directories
+ */
+std::vector<std::string> BatchCalibrator::read_list(const std::string& filename) {
+    std::vector<std::string> directories;
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line)) {
+        // Trim surrounding whitespace, including a trailing carriage return
+        size_t begin = line.find_first_not_of(" \t\r");
+        size_t end = line.find_last_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        directories.push_back(line.substr(begin, end - begin + 1));
+    }
+    return directories;
+}
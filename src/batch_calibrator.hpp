@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "calibrator.hpp"
+#include "chessboard.hpp"
+#include "frame_processor.hpp"
+#include "thread_budget.hpp"
+
+
+/**
+ * @brief Outcome of calibrating one dataset of a batch
+ */
+struct DatasetReport {
+    std::string directory;          // Frame directory of the dataset
+    std::string calibration_file;   // Saved calibration, empty if calibration failed
+    int frames = 0;                 // Number of image files
+    int accepted = 0;               // Number of frames used as calibration samples
+    bool calibrated = false;        // Calibration succeeded
+    bool converged = false;         // Intrinsics uncertainty below the targets
+    double reproj_error = 0.0;      // RMS reprojection error of the calibration
+};
+
+/**
+ * @class BatchCalibrator
+ * @brief Calibrate many still-frame datasets on one shared worker pool
+ *
+ * Frames of all datasets are interleaved into one work list on a work-stealing scheduler, so detection
+ * keeps every core busy until the last frame of the largest dataset, instead of waiting for datasets one
+ * after the other.
+ * Each dataset is then calibrated from its accepted frames in file order, datasets in parallel
+ */
+class BatchCalibrator {
+public:
+    /**
+     * @brief Construct a new BatchCalibrator object
+     * @param board Chessboard model shared by all datasets
+     * @param output_dir Directory for the per-dataset calibration files and the summary report
+     * @param targets Uncertainty targets reported per dataset
+     */
+    BatchCalibrator(const Chessboard& board, const std::string& output_dir, const ConvergenceTargets& targets);
+
+    /**
+     * @brief Add a dataset to the batch
+     * @param directory Directory of still frames
+     * @return true if the directory contains at least one image file
+     */
+    bool add_dataset(const std::string& directory);
+
+    /**
+     * @brief Detect on all datasets, calibrate each, and save the calibration files
+     * @param budget Thread budget whose pool runs the detection
+     * @return Number of datasets calibrated successfully
+     */
+    size_t run(ThreadBudget& budget);
+
+    /**
+     * @brief Save the summary of all datasets
+     * @param filename Output filename, YAML or XML supported by OpenCV
+     */
+    void save_report(const std::string& filename) const;
+
+    /**
+     * @brief Get the outcome of every dataset, in the order they were added
+     * @return Per-dataset reports
+     */
+    const std::vector<DatasetReport>& get_reports() const;
+
+    /**
+     * @brief Read a dataset list, one directory per line, blank lines and lines starting with # ignored
+     * @param filename List file
+     * @return Dataset directories
+     */
+    static std::vector<std::string> read_list(const std::string& filename);
+
+private:
+    /**
+     * @brief Frames and detections of one dataset
+     */
+    struct Dataset {
+        std::vector<std::string> files;     // Image files, sorted
+        std::vector<FrameResult> results;   // Detection per image file
+        cv::Size image_size;                // Size of the first image
+    };
+
+    /**
+     * @brief Calibrate one dataset from its accepted frames in file order
+     * @param index Index of the dataset
+     */
+    void calibrate_dataset(size_t index);
+
+    FrameProcessor processor_;
+    std::string output_dir_;
+    ConvergenceTargets targets_;
+
+    std::vector<Dataset> datasets_;
+    std::vector<DatasetReport> reports_;
+};
@@ -23,6 +23,19 @@ Calibrator::Calibrator() {
  * @param object_pts Corresponding 3D object points, chessboard model
  */
 void Calibrator::add_sample(const std::vector<cv::Point2f>& image_pts, const std::vector<cv::Point3f>& object_pts) {
+    image_points_.push_back(cv::Mat(image_pts, true));
+    object_points_.push_back(cv::Mat(object_pts, true));
+}
+
+/**
+ * @brief Add a calibration sample without copying the point data
+ *
+ * Store only the matrix headers. Collecting samples costs no copy, but cv::calibrateCamera still copies
+ * the points of every view into its own buffers on each call, so calibration memory grows with the samples
+ * @param image_pts 2D image points, Nx1 CV_32FC2
+ * @param object_pts Corresponding 3D object points, Nx1 CV_32FC3
+ */
+void Calibrator::add_sample(const cv::Mat& image_pts, const cv::Mat& object_pts) {
     image_points_.push_back(image_pts);
     object_points_.push_back(object_pts);
 }
@@ -38,14 +51,48 @@ bool Calibrator::calibrate(const cv::Size& image_size) {
     if (image_points_.empty() || object_points_.empty()) {
         return false; // No data to calibrate
     }
-    std::vector<cv::Mat> rvecs, tvecs;
+    cv::Mat std_extrinsics;
     
-    // Calibrate the camera and compute reprojection error
-    double err = cv::calibrateCamera(object_points_, image_points_, image_size, camera_matrix_, dist_coeffs_, rvecs, tvecs);
+    // Calibrate the camera and compute reprojection error, parameter uncertainty, and per-view extrinsics
+    double err = cv::calibrateCamera(object_points_, image_points_, image_size, camera_matrix_, dist_coeffs_, 
+                                     rvecs_, tvecs_, std_intrinsics_, std_extrinsics, per_view_errors_);
     reproj_error_ = err;
     return true;
 }
 
+/**
+ * @brief Check whether the last calibration meets the given uncertainty targets
+ *
+ * Compare the standard deviations of focal length, principal point, and the five
+ * standard distortion coefficients against the targets
+ * @param targets Minimum sample count and maximum standard deviations of the intrinsics
+ * @return true if the intrinsics are known well enough to stop collecting samples
+ */
+bool Calibrator::has_converged(const ConvergenceTargets& targets) const {
+    if ((int)image_points_.size() < targets.min_samples || std_intrinsics_.rows < 9) {
+        return false; // Not enough samples or not calibrated yet
+    }
+
+    // Written as not within the target, so a NaN deviation of a degenerate calibration fails
+    auto within = [&](int i, double target) { return std_intrinsics_.at<double>(i) <= target; };
+
+    // Focal length fx, fy and principal point cx, cy
+    if (!within(0, targets.focal_std) || !within(1, targets.focal_std)) {
+        return false;
+    }
+    if (!within(2, targets.principal_std) || !within(3, targets.principal_std)) {
+        return false;
+    }
+
+    // Distortion coefficients k1, k2, p1, p2, k3
+    for (int i = 4; i < 9; ++i) {
+        if (!within(i, targets.distortion_std)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * @brief Save the calibration results, camera matrix and distortion coefficients, to a file
  *
@@ -56,9 +103,37 @@ void Calibrator::save(const std::string& filename) const {
     cv::FileStorage fs(filename, cv::FileStorage::WRITE);
     fs << "cameraMatrix" << camera_matrix_;
     fs << "distCoeffs" << dist_coeffs_;
+    fs << "stdIntrinsics" << std_intrinsics_;
+    fs << "reprojError" << reproj_error_;
     fs.release();
 }
 
+/**
+ * @brief Load a camera matrix and distortion coefficients saved earlier
+ *
+ * Only the intrinsics are restored, collected samples and per-view results are left untouched
+ * @param filename Input filename, YAML or XML written by save
+ * @return true if both are loaded, false otherwise
+ */
+bool Calibrator::load(const std::string& filename) {
+    cv::FileStorage fs(filename, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        return false;
+    }
+
+    cv::Mat K, dist;
+    fs["cameraMatrix"] >> K;
+    fs["distCoeffs"] >> dist;
+    if (K.rows != 3 || K.cols != 3 || dist.empty()) {
+        return false;
+    }
+
+    camera_matrix_ = K;
+    dist_coeffs_ = dist;
+    fs["reprojError"] >> reproj_error_;
+    return true;
+}
+
 /**
  * @brief Get the camera matrix, intrinsic parameters
  * @return Reference to the 3x3 camera matrix
@@ -82,3 +157,43 @@ const cv::Mat& Calibrator::get_dist_coeffs() const {
 double Calibrator::get_reproj_error() const {
     return reproj_error_;
 }
+
+/**
+ * @brief Get the standard deviations of the intrinsics from the last calibration
+ * @return Column vector ordered fx, fy, cx, cy, k1, k2, p1, p2, k3, ..., empty before calibration
+ */
+const cv::Mat& Calibrator::get_std_intrinsics() const {
+    return std_intrinsics_;
+}
+
+/**
+ * @brief Get the board rotation of every sample from the last calibration
+ * @return Rotation vectors, Rodrigues, in sample order
+ */
+const std::vector<cv::Mat>& Calibrator::get_rvecs() const {
+    return rvecs_;
+}
+
+/**
+ * @brief Get the board translation of every sample from the last calibration
+ * @return Translation vectors, in sample order
+ */
+const std::vector<cv::Mat>& Calibrator::get_tvecs() const {
+    return tvecs_;
+}
+
+/**
+ * @brief Get the RMS reprojection error of every sample from the last calibration
+ * @return Column vector of per-view errors, in sample order
+ */
+const cv::Mat& Calibrator::get_per_view_errors() const {
+    return per_view_errors_;
+}
+
+/**
+ * @brief Get the number of collected calibration samples
+ * @return Number of samples added so far
+ */
+size_t Calibrator::get_num_samples() const {
+    return image_points_.size();
+}
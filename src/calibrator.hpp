@@ -6,6 +6,18 @@
 #include <opencv2/opencv.hpp>
 
 
+/**
+ * @brief Uncertainty targets that decide when enough calibration samples have been collected
+ *
+ * Standard deviations are taken from the extended outputs of cv::calibrateCamera
+ */
+struct ConvergenceTargets {
+    int min_samples = 5;             // Never stop before this many samples are collected
+    double focal_std = 2.0;          // Maximum standard deviation of fx and fy, in pixels
+    double principal_std = 2.0;      // Maximum standard deviation of cx and cy, in pixels
+    double distortion_std = 0.02;    // Maximum standard deviation of k1, k2, p1, p2, k3
+};
+
 /**
  * @class Calibrator
  * @brief Handle camera calibration logic: collect calibration points, run calibration, and save results
@@ -30,6 +42,17 @@ public:
      */
     void add_sample(const std::vector<cv::Point2f>& image_pts, const std::vector<cv::Point3f>& object_pts);
 
+    /**
+     * @brief Add a calibration sample without copying the point data
+     *
+     * The matrices only reference their data, which must outlive the calibrator,
+     * for example rows of a memory-mapped CornerStoreReader. calibrate still copies the points into
+     * OpenCV's own buffers
+     * @param image_pts 2D image points, Nx1 CV_32FC2
+     * @param object_pts Corresponding 3D object points, Nx1 CV_32FC3
+     */
+    void add_sample(const cv::Mat& image_pts, const cv::Mat& object_pts);
+
     /**
      * @brief Run camera calibration using all collected samples
      * @param image_size Size of the calibration images
@@ -37,11 +60,25 @@ public:
      */
     bool calibrate(const cv::Size& image_size);
 
+    /**
+     * @brief Check whether the last calibration meets the given uncertainty targets
+     * @param targets Minimum sample count and maximum standard deviations of the intrinsics
+     * @return true if the intrinsics are known well enough to stop collecting samples
+     */
+    bool has_converged(const ConvergenceTargets& targets) const;
+
     /**
      * @brief Save the calibration results, camera matrix and distortion coefficients, to a file
      * @param filename Output filename, YAML or XML supported by OpenCV
      */
     void save(const std::string& filename) const;
+
+    /**
+     * @brief Load a camera matrix and distortion coefficients saved earlier
+     * @param filename Input filename, YAML or XML written by save
+     * @return true if both are loaded, false otherwise
+     */
+    bool load(const std::string& filename);
     
     /**
      * @brief Get the camera matrix, intrinsic parameters
@@ -61,12 +98,47 @@ public:
      */
     double get_reproj_error() const;
 
+    /**
+     * @brief Get the standard deviations of the intrinsics from the last calibration
+     * @return Column vector ordered fx, fy, cx, cy, k1, k2, p1, p2, k3, ..., empty before calibration
+     */
+    const cv::Mat& get_std_intrinsics() const;
+
+    /**
+     * @brief Get the board rotation of every sample from the last calibration
+     * @return Rotation vectors, Rodrigues, in sample order
+     */
+    const std::vector<cv::Mat>& get_rvecs() const;
+
+    /**
+     * @brief Get the board translation of every sample from the last calibration
+     * @return Translation vectors, in sample order
+     */
+    const std::vector<cv::Mat>& get_tvecs() const;
+
+    /**
+     * @brief Get the RMS reprojection error of every sample from the last calibration
+     * @return Column vector of per-view errors, in sample order
+     */
+    const cv::Mat& get_per_view_errors() const;
+
+    /**
+     * @brief Get the number of collected calibration samples
+     * @return Number of samples added so far
+     */
+    size_t get_num_samples() const;
+
 private:
     double reproj_error_ = 0.0;
 
     cv::Mat camera_matrix_;
     cv::Mat dist_coeffs_;
+    cv::Mat std_intrinsics_;
+    cv::Mat per_view_errors_;
+
+    std::vector<cv::Mat> rvecs_;          // Per-view board rotation from the last calibration
+    std::vector<cv::Mat> tvecs_;          // Per-view board translation from the last calibration
 
-    std::vector<std::vector<cv::Point2f>> image_points_;
-    std::vector<std::vector<cv::Point3f>> object_points_;
+    std::vector<cv::Mat> image_points_;   // Nx1 CV_32FC2 per sample
+    std::vector<cv::Mat> object_points_;  // Nx1 CV_32FC3 per sample
 };
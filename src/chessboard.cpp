@@ -1,5 +1,7 @@
 #include "chessboard.hpp"
 
+#include <algorithm>
+
 #include <opencv2/opencv.hpp>
 
 
@@ -69,6 +71,35 @@ void Chessboard::reorder_corners(std::vector<cv::Point2f>& corners, int a1_index
     corners = ordered;
 }
 
+/**
+ * @brief Turn a view of the board by half a turn, reverse the corners and move the pose to the opposite outer corner
+ *
+ * The corner grid maps onto itself under a half turn about the board center, so a view and its turned
+ * twin fit the image equally well, and two cameras seeing the same board may each pick either one.
+ * Reversing the corners relabels corner i as corner n-1-i, whose object point is the sum of the first
+ * and last object points minus object point i, so the pose is composed with that half turn
+ * @param image_pts Input/output corners in A1 order, reversed
+ * @param object_pts 3D object points of the board, generate_object_points order
+ * @param rvec Input/output board rotation, Rodrigues
+ * @param tvec Input/output board translation
+ */
+void Chessboard::half_turn(std::vector<cv::Point2f>& image_pts, const std::vector<cv::Point3f>& object_pts,
+                           cv::Vec3d& rvec, cv::Vec3d& tvec)
+{
+    std::reverse(image_pts.begin(), image_pts.end());
+    if (object_pts.empty()) {
+        return;
+    }
+
+    cv::Point3f span = object_pts.front() + object_pts.back();
+    cv::Vec3d turn_rvec(0.0, 0.0, CV_PI);
+    cv::Vec3d turn_tvec(span.x, span.y, span.z);
+    cv::Vec3d turned_rvec, turned_tvec;
+    cv::composeRT(turn_rvec, turn_tvec, rvec, tvec, turned_rvec, turned_tvec);
+    rvec = turned_rvec;
+    tvec = turned_tvec;
+}
+
 /**
  * @brief Find the index of the A1 origin corner by checking the brightness of the outer squares
  *
@@ -190,3 +221,19 @@ std::vector<cv::Point3f> Chessboard::generate_object_points() const {
     }
     return obj_pts;
 }
+
+/**
+ * @brief Get the pattern size in inner corners
+ * @return Inner corners along X and Y
+ */
+cv::Size Chessboard::get_pattern_size() const {
+    return cv::Size(corners_x_, corners_y_);
+}
+
+/**
+ * @brief Get the physical size of a chessboard square
+ * @return Square size, arbitrary units
+ */
+float Chessboard::get_square_size() const {
+    return square_size_;
+}
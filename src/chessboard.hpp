@@ -37,6 +37,16 @@ public:
      */
     void reorder_corners(std::vector<cv::Point2f>& corners, int a1_index) const;
 
+    /**
+     * @brief Turn a view of the board by half a turn, reverse the corners and move the pose to the opposite outer corner
+     * @param image_pts Input/output corners in A1 order, reversed
+     * @param object_pts 3D object points of the board, generate_object_points order
+     * @param rvec Input/output board rotation, Rodrigues
+     * @param tvec Input/output board translation
+     */
+    static void half_turn(std::vector<cv::Point2f>& image_pts, const std::vector<cv::Point3f>& object_pts,
+                          cv::Vec3d& rvec, cv::Vec3d& tvec);
+
     /**
      * @brief Find the index of the A1 origin corner by checking the brightness of the outer squares
      * @param gray Grayscale image
@@ -59,6 +69,18 @@ public:
      */
     std::vector<cv::Point3f> generate_object_points() const;
 
+    /**
+     * @brief Get the pattern size in inner corners
+     * @return Inner corners along X and Y
+     */
+    cv::Size get_pattern_size() const;
+
+    /**
+     * @brief Get the physical size of a chessboard square
+     * @return Square size, arbitrary units
+     */
+    float get_square_size() const;
+
 private:
     int corners_x_;
     int corners_y_;
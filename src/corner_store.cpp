@@ -0,0 +1,407 @@
+#include "corner_store.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+
+#include <opencv2/core.hpp>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+constexpr int STORE_VERSION = 1;
+constexpr size_t POSE_STRIDE = 6 * sizeof(double);     // rvec, tvec
+constexpr size_t QUALITY_STRIDE = 2 * sizeof(float);   // reprojection error, sharpness
+constexpr int NUM_COLUMNS = 5;                          // frame_id, a1_index, image_points, pose, quality
+
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Map a file into memory, leave the mapping empty if the file is missing or empty
+     * @param path Path of the file to map
+     */
+    explicit MappedFile(const std::filesystem::path& path) {
+#if defined(_WIN32)
+        file_ = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            return;
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_, &file_size) || file_size.QuadPart == 0) {
+            return;
+        }
+
+        mapping_ = CreateFileMappingW(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping_ == NULL) {
+            return;
+        }
+
+        data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        size_ = data_ ? static_cast<size_t>(file_size.QuadPart) : 0;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED) {
+                data_ = static_cast<const unsigned char*>(addr);
+                size_ = static_cast<size_t>(st.st_size);
+
+                // Rows are mostly read front to back
+                madvise(addr, size_, MADV_SEQUENTIAL);
+            }
+        }
+
+        // The mapping stays valid after closing the descriptor
+        close(fd);
+#endif
+    }
+
+    /**
+     * @brief Unmap the file
+     */
+    ~MappedFile() {
+#if defined(_WIN32)
+        if (data_) { UnmapViewOfFile(data_); }
+        if (mapping_ != NULL) { CloseHandle(mapping_); }
+        if (file_ != INVALID_HANDLE_VALUE) { CloseHandle(file_); }
+#else
+        if (data_) { munmap(const_cast<unsigned char*>(data_), size_); }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = NULL;
+#endif
+};
+
+
+/**
+ * @brief Open a corner store for appending, create it if it does not exist
+ *
+ * Write meta.yml for a new store, or check that an existing store has the same corner count and
+ * frame size and truncate its columns to their common row count
+ * @param directory Store directory
+ * @param num_corners Number of chessboard corners per detection
+ * @param image_size Size of the frames the detections come from
+ */
+CornerStoreWriter::CornerStoreWriter(const std::string& directory, int num_corners, const cv::Size& image_size)
+    : num_corners_(num_corners)
+{
+    if (num_corners <= 0) {
+        return;
+    }
+
+    std::filesystem::path dir(directory);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        return;
+    }
+
+    // Column files with their row strides
+    const std::pair<std::filesystem::path, size_t> columns[NUM_COLUMNS] = {
+        { dir / "frame_id.i64", sizeof(int64_t) },
+        { dir / "a1_index.i32", sizeof(int32_t) },
+        { dir / "image_points.f32", num_corners * sizeof(cv::Point2f) },
+        { dir / "pose.f64", POSE_STRIDE },
+        { dir / "quality.f32", QUALITY_STRIDE }
+    };
+
+    std::filesystem::path meta_path = dir / "meta.yml";
+    if (std::filesystem::exists(meta_path)) {
+        // Appending to an existing store, the layout and the frame size must match, --resolve calibrates with the stored size
+        cv::FileStorage fs(meta_path.string(), cv::FileStorage::READ);
+        if (!fs.isOpened() || (int)fs["version"] != STORE_VERSION || (int)fs["corners"] != num_corners ||
+            (int)fs["imageWidth"] != image_size.width || (int)fs["imageHeight"] != image_size.height) {
+            return;
+        }
+
+        // A crash or partial write leaves the columns at different lengths, cut them all back to the
+        // complete rows so appended rows stay aligned
+        uintmax_t bytes[NUM_COLUMNS] = {};
+        size_t rows = SIZE_MAX;
+        for (int c = 0; c < NUM_COLUMNS; ++c) {
+            if (std::filesystem::exists(columns[c].first)) {
+                bytes[c] = std::filesystem::file_size(columns[c].first, ec);
+                if (ec) {
+                    return;
+                }
+            }
+            rows = std::min(rows, (size_t)(bytes[c] / columns[c].second));
+        }
+        for (int c = 0; c < NUM_COLUMNS; ++c) {
+            if (bytes[c] != rows * columns[c].second) {
+                std::filesystem::resize_file(columns[c].first, rows * columns[c].second, ec);
+                if (ec) {
+                    return;
+                }
+            }
+        }
+    }
+    else {
+        cv::FileStorage fs(meta_path.string(), cv::FileStorage::WRITE);
+        fs << "version" << STORE_VERSION;
+        fs << "corners" << num_corners;
+        fs << "imageWidth" << image_size.width;
+        fs << "imageHeight" << image_size.height;
+        fs.release();
+    }
+
+    auto mode = std::ios::binary | std::ios::app;
+    frame_id_.open(columns[0].first, mode);
+    a1_index_.open(columns[1].first, mode);
+    image_points_.open(columns[2].first, mode);
+    pose_.open(columns[3].first, mode);
+    quality_.open(columns[4].first, mode);
+
+    opened_ = frame_id_.is_open() && a1_index_.is_open() && image_points_.is_open() &&
+              pose_.is_open() && quality_.is_open();
+}
+
+/**
+ * @brief Check if the store is open for appending
+ * @return true if all columns are open, false if the store could not be created or does not match the corner count or frame size
+ */
+bool CornerStoreWriter::is_opened() const {
+    return opened_;
+}
+
+/**
+ * @brief Append one detection to all columns
+ *
+ * Write one fixed-stride row to every column, in the native byte order
+ * @param record Detection to append, must have num_corners image points
+ * @return true if the record is written, false otherwise
+ */
+bool CornerStoreWriter::append(const CornerRecord& record) {
+    if (!opened_ || (int)record.image_pts.size() != num_corners_) {
+        return false;
+    }
+
+    double pose[6] = { record.rvec[0], record.rvec[1], record.rvec[2],
+                       record.tvec[0], record.tvec[1], record.tvec[2] };
+    float quality[2] = { record.reproj_error, record.sharpness };
+
+    frame_id_.write(reinterpret_cast<const char*>(&record.frame_id), sizeof(int64_t));
+    a1_index_.write(reinterpret_cast<const char*>(&record.a1_index), sizeof(int32_t));
+    image_points_.write(reinterpret_cast<const char*>(record.image_pts.data()), num_corners_ * sizeof(cv::Point2f));
+    pose_.write(reinterpret_cast<const char*>(pose), POSE_STRIDE);
+    quality_.write(reinterpret_cast<const char*>(quality), QUALITY_STRIDE);
+
+    return frame_id_.good() && a1_index_.good() && image_points_.good() && pose_.good() && quality_.good();
+}
+
+/**
+ * @brief Flush all columns to disk
+ */
+void CornerStoreWriter::flush() {
+    frame_id_.flush();
+    a1_index_.flush();
+    image_points_.flush();
+    pose_.flush();
+    quality_.flush();
+}
+
+
+/**
+ * @brief Map the columns of a corner store
+ *
+ * Read the layout from meta.yml and map every column, the row count is that of the shortest column
+ * @param directory Store directory
+ */
+CornerStoreReader::CornerStoreReader(const std::string& directory) {
+    std::filesystem::path dir(directory);
+
+    cv::FileStorage fs((dir / "meta.yml").string(), cv::FileStorage::READ);
+    if (!fs.isOpened() || (int)fs["version"] != STORE_VERSION) {
+        return;
+    }
+    num_corners_ = (int)fs["corners"];
+    image_size_ = cv::Size((int)fs["imageWidth"], (int)fs["imageHeight"]);
+    if (num_corners_ <= 0) {
+        return;
+    }
+
+    frame_id_ = std::make_unique<MappedFile>(dir / "frame_id.i64");
+    a1_index_ = std::make_unique<MappedFile>(dir / "a1_index.i32");
+    image_points_ = std::make_unique<MappedFile>(dir / "image_points.f32");
+    pose_ = std::make_unique<MappedFile>(dir / "pose.f64");
+    quality_ = std::make_unique<MappedFile>(dir / "quality.f32");
+
+    rows_ = std::min({
+        frame_id_->size() / sizeof(int64_t),
+        a1_index_->size() / sizeof(int32_t),
+        image_points_->size() / (num_corners_ * sizeof(cv::Point2f)),
+        pose_->size() / POSE_STRIDE,
+        quality_->size() / QUALITY_STRIDE
+    });
+}
+
+/**
+ * @brief Unmap all columns
+ */
+CornerStoreReader::~CornerStoreReader() = default;
+
+/**
+ * @brief Check if the store is mapped and readable
+ * @return true if the meta data and all columns are available, false otherwise
+ */
+bool CornerStoreReader::is_opened() const {
+    return num_corners_ > 0 && frame_id_ != nullptr;
+}
+
+/**
+ * @brief Get the number of detections in the store
+ * @return Number of complete rows
+ */
+size_t CornerStoreReader::size() const {
+    return rows_;
+}
+
+/**
+ * @brief Get the number of chessboard corners per detection
+ * @return Number of corners
+ */
+int CornerStoreReader::get_num_corners() const {
+    return num_corners_;
+}
+
+/**
+ * @brief Get the size of the frames the detections come from
+ * @return Frame size as cv::Size
+ */
+cv::Size CornerStoreReader::get_image_size() const {
+    return image_size_;
+}
+
+/**
+ * @brief Get the frame index of a detection
+ * @param i Row index
+ * @return Frame index in its session
+ */
+int64_t CornerStoreReader::frame_id(size_t i) const {
+    int64_t value;
+    std::memcpy(&value, frame_id_->data() + i * sizeof(int64_t), sizeof(int64_t));
+    return value;
+}
+
+/**
+ * @brief Get the A1 corner index of a detection
+ * @param i Row index
+ * @return Outer corner used as A1, 0=TL, 1=TR, 2=BL, 3=BR
+ */
+int CornerStoreReader::a1_index(size_t i) const {
+    int32_t value;
+    std::memcpy(&value, a1_index_->data() + i * sizeof(int32_t), sizeof(int32_t));
+    return value;
+}
+
+/**
+ * @brief Get the board rotation of a detection
+ * @param i Row index
+ * @return Rotation vector, Rodrigues
+ */
+cv::Vec3d CornerStoreReader::rvec(size_t i) const {
+    cv::Vec3d value;
+    std::memcpy(value.val, pose_->data() + i * POSE_STRIDE, 3 * sizeof(double));
+    return value;
+}
+
+/**
+ * @brief Get the board translation of a detection
+ * @param i Row index
+ * @return Translation vector
+ */
+cv::Vec3d CornerStoreReader::tvec(size_t i) const {
+    cv::Vec3d value;
+    std::memcpy(value.val, pose_->data() + i * POSE_STRIDE + 3 * sizeof(double), 3 * sizeof(double));
+    return value;
+}
+
+/**
+ * @brief Get the pose reprojection error of a detection
+ * @param i Row index
+ * @return Mean reprojection error, in pixels
+ */
+float CornerStoreReader::reproj_error(size_t i) const {
+    float value;
+    std::memcpy(&value, quality_->data() + i * QUALITY_STRIDE, sizeof(float));
+    return value;
+}
+
+/**
+ * @brief Get the sharpness of the frame of a detection
+ * @param i Row index
+ * @return Laplacian variance of the frame
+ */
+float CornerStoreReader::sharpness(size_t i) const {
+    float value;
+    std::memcpy(&value, quality_->data() + i * QUALITY_STRIDE + sizeof(float), sizeof(float));
+    return value;
+}
+
+/**
+ * @brief Get the image points of a detection without copying
+ *
+ * The matrix header points into the read-only mapping, it must not be written to
+ * @param i Row index
+ * @return Nx1 CV_32FC2 matrix header onto the mapped column, valid while the reader lives
+ */
+cv::Mat CornerStoreReader::image_points(size_t i) const {
+    const unsigned char* row = image_points_->data() + i * num_corners_ * sizeof(cv::Point2f);
+    return cv::Mat(num_corners_, 1, CV_32FC2, const_cast<unsigned char*>(row));
+}
+
+/**
+ * @brief Add the stored detections to a calibrator without copying the image points
+ *
+ * With max_samples set, rows are picked at an even stride over the whole store. Only loading is free of
+ * copies: cv::calibrateCamera copies every view into its own buffers when the calibrator runs, so the
+ * memory of a re-solve grows with the number of samples, which max_samples bounds
+ * @param calibrator Calibrator to add the samples to, must not outlive the reader
+ * @param object_pts Object points shared by all samples, Nx1 CV_32FC3
+ * @return Number of samples added
+ */
+size_t CornerStoreReader::load_into(Calibrator& calibrator, const cv::Mat& object_pts, size_t max_samples) const {
+    if (rows_ == 0 || object_pts.total() != (size_t)num_corners_) {
+        return 0;
+    }
+
+    size_t count = (max_samples == 0) ? rows_ : std::min(rows_, max_samples);
+    for (size_t k = 0; k < count; ++k) {
+        size_t i = k * rows_ / count;
+        calibrator.add_sample(image_points(i), object_pts);
+    }
+    return count;
+}
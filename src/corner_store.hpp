@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "calibrator.hpp"
+
+
+/**
+ * @brief One chessboard detection as stored in a corner store
+ */
+struct CornerRecord {
+    int64_t frame_id = 0;                 // Index of the frame in its session
+    int32_t a1_index = -1;                // Outer corner used as A1, 0=TL, 1=TR, 2=BL, 3=BR
+    std::vector<cv::Point2f> image_pts;   // Detected corners in A1 order
+    cv::Vec3d rvec;                       // Board pose rotation, Rodrigues
+    cv::Vec3d tvec;                       // Board pose translation
+    float reproj_error = 0.0f;            // Mean reprojection error of the pose, in pixels
+    float sharpness = 0.0f;               // Laplacian variance of the frame
+};
+
+/**
+ * @brief Append chessboard detections to an on-disk columnar corner store
+ *
+ * A store is a directory with a meta.yml and one binary file per column. Every column has a
+ * fixed stride, so row i of every column is found at offset i * stride without parsing:
+ * frame_id.i64, a1_index.i32, image_points.f32 (2 floats per corner), pose.f64 (rvec, tvec),
+ * and quality.f32 (reprojection error, sharpness). Reopening a store truncates every column to the
+ * rows complete in all of them, dropping a row left partial by a crash
+ */
+class CornerStoreWriter {
+public:
+    /**
+     * @brief Open a corner store for appending, create it if it does not exist
+     * @param directory Store directory
+     * @param num_corners Number of chessboard corners per detection
+     * @param image_size Size of the frames the detections come from
+     */
+    CornerStoreWriter(const std::string& directory, int num_corners, const cv::Size& image_size);
+
+    /**
+     * @brief Check if the store is open for appending
+     * @return true if all columns are open, false if the store could not be created or does not match the corner count or frame size
+     */
+    bool is_opened() const;
+
+    /**
+     * @brief Append one detection to all columns
+     * @param record Detection to append, must have num_corners image points
+     * @return true if the record is written, false otherwise
+     */
+    bool append(const CornerRecord& record);
+
+    /**
+     * @brief Flush all columns to disk
+     */
+    void flush();
+
+private:
+    int num_corners_ = 0;
+    bool opened_ = false;
+
+    std::ofstream frame_id_;
+    std::ofstream a1_index_;
+    std::ofstream image_points_;
+    std::ofstream pose_;
+    std::ofstream quality_;
+};
+
+class MappedFile;
+
+/**
+ * @brief Read a corner store through memory-mapped columns
+ *
+ * Nothing is parsed or copied on open, rows are read in place from the mapped files.
+ * The number of rows is taken from the shortest column, so a partially written last row is ignored
+ */
+class CornerStoreReader {
+public:
+    /**
+     * @brief Map the columns of a corner store
+     * @param directory Store directory
+     */
+    explicit CornerStoreReader(const std::string& directory);
+    ~CornerStoreReader();
+
+    /**
+     * @brief Check if the store is mapped and readable
+     * @return true if the meta data and all columns are available, false otherwise
+     */
+    bool is_opened() const;
+
+    /**
+     * @brief Get the number of detections in the store
+     * @return Number of complete rows
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the number of chessboard corners per detection
+     * @return Number of corners
+     */
+    int get_num_corners() const;
+
+    /**
+     * @brief Get the size of the frames the detections come from
+     * @return Frame size as cv::Size
+     */
+    cv::Size get_image_size() const;
+
+    /**
+     * @brief Get the frame index of a detection
+     * @param i Row index
+     * @return Frame index in its session
+     */
+    int64_t frame_id(size_t i) const;
+
+    /**
+     * @brief Get the A1 corner index of a detection
+     * @param i Row index
+     * @return Outer corner used as A1, 0=TL, 1=TR, 2=BL, 3=BR
+     */
+    int a1_index(size_t i) const;
+
+    /**
+     * @brief Get the board rotation of a detection
+     * @param i Row index
+     * @return Rotation vector, Rodrigues
+     */
+    cv::Vec3d rvec(size_t i) const;
+
+    /**
+     * @brief Get the board translation of a detection
+     * @param i Row index
+     * @return Translation vector
+     */
+    cv::Vec3d tvec(size_t i) const;
+
+    /**
+     * @brief Get the pose reprojection error of a detection
+     * @param i Row index
+     * @return Mean reprojection error, in pixels
+     */
+    float reproj_error(size_t i) const;
+
+    /**
+     * @brief Get the sharpness of the frame of a detection
+     * @param i Row index
+     * @return Laplacian variance of the frame
+     */
+    float sharpness(size_t i) const;
+
+    /**
+     * @brief Get the image points of a detection without copying
+     * @param i Row index
+     * @return Nx1 CV_32FC2 matrix header onto the mapped column, valid while the reader lives
+     */
+    cv::Mat image_points(size_t i) const;
+
+    /**
+     * @brief Add the stored detections to a calibrator without copying the image points
+     *
+     * With max_samples set, rows are picked at an even stride over the whole store. Calibrating
+     * still copies every sample into OpenCV's buffers, so its memory grows with max_samples
+     * @param calibrator Calibrator to add the samples to, must not outlive the reader
+     * @param object_pts Object points shared by all samples, Nx1 CV_32FC3
+     * @param max_samples Maximum number of samples to add, 0 for all
+     * @return Number of samples added
+     */
+    size_t load_into(Calibrator& calibrator, const cv::Mat& object_pts, size_t max_samples = 0) const;
+
+private:
+    int num_corners_ = 0;
+    size_t rows_ = 0;
+    cv::Size image_size_;
+
+    std::unique_ptr<MappedFile> frame_id_;
+    std::unique_ptr<MappedFile> a1_index_;
+    std::unique_ptr<MappedFile> image_points_;
+    std::unique_ptr<MappedFile> pose_;
+    std::unique_ptr<MappedFile> quality_;
+};
@@ -0,0 +1,204 @@
+#include "display_thread.hpp"
+
+#include <chrono>
+#include <utility>
+
+#include "utils.hpp"
+
+
+constexpr int EVENT_INTERVAL_MS = 10;     // Longest wait for a frame before GUI events are handled
+
+
+/**
+ * @brief Create the window and start the display thread
+ * @param window_name Name of the window
+ * @param size Size of the window, shown black until the first frame
+ * @param init Function called first on the display thread, e.g. to pin it to CPUs, not called when frames are shown inline
+ */
+DisplayThread::DisplayThread(const std::string& window_name, cv::Size size, std::function<void()> init)
+    : window_name_(window_name), size_(size)
+{
+#if defined(__APPLE__)
+    (void)init;
+    threaded_ = false;
+    open_window();
+#else
+    threaded_ = true;
+    worker_ = std::thread(&DisplayThread::run, this, std::move(init));
+#endif
+}
+
+/**
+ * @brief Stop the display thread, the window stays open
+ */
+DisplayThread::~DisplayThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    frame_ready_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+/**
+ * @brief Hand a frame to the display, never waits for it to be shown
+ *
+ * Three buffers rotate without copies: the caller's, the mailbox, and the one being shown
+ * @param frame Frame to show, swapped with a free buffer whose content is undefined, reuse it for the next frame
+ * @param hold_ms How long the frame stays on screen before a newer one replaces it, 0 for no hold
+ */
+void DisplayThread::post(cv::Mat& frame, int hold_ms) {
+    using Clock = std::chrono::steady_clock;
+    posted_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!threaded_) {
+        // Inline display, frames posted during a hold are not shown but events are still handled
+        if (Clock::now() >= hold_until_) {
+            cv::imshow(window_name_, frame);
+            hold_until_ = Clock::now() + std::chrono::milliseconds(hold_ms);
+        }
+        else {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        int key = cv::waitKey(1);
+        if (key >= 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            keys_.push_back(key);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (has_frame_) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::swap(mailbox_, frame);
+        mailbox_hold_ms_ = hold_ms;
+        has_frame_ = true;
+    }
+    frame_ready_.notify_one();
+}
+
+/**
+ * @brief Get the oldest key pressed in the window, without waiting
+ * @return Key code, -1 if no key was pressed
+ */
+int DisplayThread::poll_key() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (keys_.empty()) {
+        return -1;
+    }
+    int key = keys_.front();
+    keys_.pop_front();
+    return key;
+}
+
+/**
+ * @brief Wait for a key press in the window
+ * @param timeout_ms Longest wait in milliseconds, 0 to wait forever
+ * @return Key code, -1 if the wait timed out
+ */
+int DisplayThread::wait_key(int timeout_ms) {
+    int key = poll_key();
+    if (key >= 0) {
+        return key;
+    }
+    if (!threaded_) {
+        return cv::waitKey(timeout_ms);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto pressed = [&]() { return !keys_.empty(); };
+    if (timeout_ms <= 0) {
+        key_ready_.wait(lock, pressed);
+    }
+    else if (!key_ready_.wait_for(lock, std::chrono::milliseconds(timeout_ms), pressed)) {
+        return -1;
+    }
+    key = keys_.front();
+    keys_.pop_front();
+    return key;
+}
+
+/**
+ * @brief Get the number of posted frames
+ * @return Number of frames handed to the display
+ */
+uint64_t DisplayThread::get_posted() const {
+    return posted_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the number of posted frames replaced before they were shown
+ * @return Number of skipped frames
+ */
+uint64_t DisplayThread::get_skipped() const {
+    return skipped_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Display thread loop, show the newest frame and collect keys until stopped
+ *
+ * Wait for a frame at most EVENT_INTERVAL_MS, so GUI events are handled even when no frames arrive.
+ * While the shown frame is held, posted frames stay in the mailbox, the newest replacing the others
+ * @param init Function called first, may be empty
+ */
+void DisplayThread::run(std::function<void()> init) {
+    using Clock = std::chrono::steady_clock;
+    if (init) {
+        init();
+    }
+    open_window();
+
+    cv::Mat front;
+    bool focused = false;
+    while (true) {
+        bool show = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            frame_ready_.wait_for(lock, std::chrono::milliseconds(EVENT_INTERVAL_MS),
+                                  [&]() { return (has_frame_ && Clock::now() >= hold_until_) || !running_; });
+            if (!running_) {
+                break;
+            }
+            if (has_frame_ && Clock::now() >= hold_until_) {
+                std::swap(front, mailbox_);
+                hold_until_ = Clock::now() + std::chrono::milliseconds(mailbox_hold_ms_);
+                has_frame_ = false;
+                show = true;
+            }
+        }
+
+        if (show) {
+            cv::imshow(window_name_, front);
+            if (!focused) {
+                Utils::focus_opencv_window(window_name_.c_str());
+                focused = true;
+            }
+        }
+
+        int key = cv::waitKey(1);
+        if (key >= 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                keys_.push_back(key);
+            }
+            key_ready_.notify_all();
+        }
+    }
+}
+
+/**
+ * @brief Create, place, and focus the window, on the thread that owns it
+ */
+void DisplayThread::open_window() {
+    cv::namedWindow(window_name_, cv::WINDOW_AUTOSIZE);
+    Utils::center_opencv_window(window_name_.c_str(), size_.width, size_.height);
+
+    // Show a blank frame to ensure the window is created and can be focused
+    cv::imshow(window_name_, cv::Mat::zeros(size_, CV_8UC3));
+    Utils::focus_opencv_window(window_name_.c_str());
+}
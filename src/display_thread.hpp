@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+
+
+/**
+ * @class DisplayThread
+ * @brief Own the preview window on a dedicated thread, fed through a single-slot mailbox
+ *
+ * The processing loop posts its newest annotated frame by swapping buffers with the mailbox, so it
+ * never waits on window repaints or GUI event handling. Frames posted faster than the window can
+ * show them replace each other in the mailbox and are counted as skipped. Key presses are queued
+ * back to the processing loop. A frame can be held on screen for a while, e.g. to let the user see
+ * an accepted overlay; frames posted meanwhile wait in the mailbox and only the newest is shown once
+ * the hold ends. All window calls, including its creation, happen on the display thread. On macOS,
+ * where the GUI must run on the main thread, frames are shown inline instead
+ */
+class DisplayThread {
+public:
+    /**
+     * @brief Create the window and start the display thread
+     * @param window_name Name of the window
+     * @param size Size of the window, shown black until the first frame
+     * @param init Function called first on the display thread, e.g. to pin it to CPUs, not called when frames are shown inline
+     */
+    DisplayThread(const std::string& window_name, cv::Size size, std::function<void()> init = nullptr);
+
+    /**
+     * @brief Stop the display thread, the window stays open
+     */
+    ~DisplayThread();
+
+    DisplayThread(const DisplayThread&) = delete;
+    DisplayThread& operator=(const DisplayThread&) = delete;
+
+    /**
+     * @brief Hand a frame to the display, never waits for it to be shown
+     * @param frame Frame to show, swapped with a free buffer whose content is undefined, reuse it for the next frame
+     * @param hold_ms How long the frame stays on screen before a newer one replaces it, 0 for no hold
+     */
+    void post(cv::Mat& frame, int hold_ms = 0);
+
+    /**
+     * @brief Get the oldest key pressed in the window, without waiting
+     * @return Key code, -1 if no key was pressed
+     */
+    int poll_key();
+
+    /**
+     * @brief Wait for a key press in the window
+     * @param timeout_ms Longest wait in milliseconds, 0 to wait forever
+     * @return Key code, -1 if the wait timed out
+     */
+    int wait_key(int timeout_ms);
+
+    /**
+     * @brief Get the number of posted frames
+     * @return Number of frames handed to the display
+     */
+    uint64_t get_posted() const;
+
+    /**
+     * @brief Get the number of posted frames replaced before they were shown
+     * @return Number of skipped frames
+     */
+    uint64_t get_skipped() const;
+
+private:
+    /**
+     * @brief Display thread loop, show the newest frame and collect keys until stopped
+     * @param init Function called first, may be empty
+     */
+    void run(std::function<void()> init);
+
+    /**
+     * @brief Create, place, and focus the window, on the thread that owns it
+     */
+    void open_window();
+
+    std::string window_name_;
+    cv::Size size_;
+    bool threaded_;
+
+    std::mutex mutex_;
+    std::condition_variable frame_ready_;   // A frame was posted or the thread is stopping
+    std::condition_variable key_ready_;     // A key was pressed
+    cv::Mat mailbox_;                       // Newest frame not yet shown
+    int mailbox_hold_ms_ = 0;               // Hold of the mailbox frame
+    bool has_frame_ = false;
+    std::chrono::steady_clock::time_point hold_until_;   // The shown frame is held until then
+    std::deque<int> keys_;
+    bool running_ = true;
+
+    std::atomic<uint64_t> posted_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::thread worker_;
+};
@@ -0,0 +1,134 @@
+#include "frame_archive.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include "overlay_scene.hpp"
+#include "renderer.hpp"
+
+
+/**
+ * @brief Construct a new FrameArchive object
+ * @param jpeg_quality JPEG quality, 0-100, for frames kept in memory
+ */
+FrameArchive::FrameArchive(int jpeg_quality) : jpeg_quality_(jpeg_quality) {}
+
+/**
+ * @brief Add a frame to the archive
+ *
+ * Keep only the path for file-backed frames, encode other frames to JPEG in memory
+ * @param frame Clean frame without overlays
+ * @param path Path of the file the frame was loaded from, empty to keep the frame in memory
+ */
+void FrameArchive::add(const cv::Mat& frame, const std::string& path) {
+    Entry entry;
+    if (!path.empty()) {
+        entry.path = path;
+    }
+    else {
+        cv::imencode(".jpg", frame, entry.encoded, { cv::IMWRITE_JPEG_QUALITY, jpeg_quality_ });
+    }
+    entries_.push_back(std::move(entry));
+}
+
+/**
+ * @brief Get the number of archived frames
+ * @return Number of frames
+ */
+size_t FrameArchive::size() const {
+    return entries_.size();
+}
+
+/**
+ * @brief Decode or load an archived frame
+ * @param i Frame index, in the order the frames were added
+ * @return Decoded frame, empty if it could not be loaded
+ */
+cv::Mat FrameArchive::get(size_t i) const {
+    const Entry& entry = entries_[i];
+    if (!entry.path.empty()) {
+        return cv::imread(entry.path);
+    }
+    return cv::imdecode(entry.encoded, cv::IMREAD_COLOR);
+}
+
+/**
+ * @brief Get the memory held by in-memory frames
+ * @return Size of all encoded frames, in bytes
+ */
+size_t FrameArchive::get_memory_usage() const {
+    size_t bytes = 0;
+    for (const auto& entry : entries_) {
+        bytes += entry.encoded.size();
+    }
+    return bytes;
+}
+
+/**
+ * @brief Render the calibrated overlay on every archived frame and save them, in parallel
+ *
+ * Frames are independent, so decoding, drawing, and encoding run across all worker threads
+ * @param directory Output directory, created if needed
+ * @param calibrator Calibrator with the intrinsics and per-view extrinsics of the archived frames
+ * @param board Chessboard model
+ * @param undistorter Undistort frames before drawing if not null
+ * @return Number of frames written
+ */
+size_t FrameArchive::export_overlays(const std::string& directory, const Calibrator& calibrator, const Chessboard& board,
+                                     const Undistorter* undistorter) const
+{
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        return 0;
+    }
+
+    // Undistorted frames are drawn with the distortion-free camera matrix
+    bool undistort = undistorter && undistorter->is_ready();
+    Projection::Projector projector = undistort ? Projection::Projector(undistorter->get_camera_matrix(), cv::Mat())
+                                                : Projection::Projector(calibrator.get_camera_matrix(), calibrator.get_dist_coeffs());
+    const auto& rvecs = calibrator.get_rvecs();
+    const auto& tvecs = calibrator.get_tvecs();
+    const cv::Mat& view_errors = calibrator.get_per_view_errors();
+    cv::Size pattern = board.get_pattern_size();
+    OverlayScene scene = OverlayScene::chessboard(pattern.height, pattern.width, board.get_square_size());
+
+    int count = (int)std::min(entries_.size(), rvecs.size());
+    std::atomic<size_t> written{0};
+
+    cv::parallel_for_(cv::Range(0, count), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            cv::Mat frame = get(i);
+            if (frame.empty()) {
+                continue;
+            }
+
+            if (undistort) {
+                cv::Mat undistorted;
+                undistorter->apply(frame, undistorted);
+                frame = undistorted;
+            }
+
+            scene.render(frame, projector, rvecs[i], tvecs[i]);
+
+            if (i < view_errors.rows) {
+                char caption[64];
+                std::snprintf(caption, sizeof(caption), "View %d, error %.3f px", i, view_errors.at<double>(i));
+                Renderer::draw_text(frame, caption, {30,30}, 1.0, cv::Scalar(255,255,255));
+            }
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%04d.png", i);
+            if (cv::imwrite((std::filesystem::path(directory) / name).string(), frame)) {
+                ++written;
+            }
+        }
+    });
+
+    return written;
+}
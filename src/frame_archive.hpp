@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "calibrator.hpp"
+#include "chessboard.hpp"
+#include "undistorter.hpp"
+
+
+/**
+ * @class FrameArchive
+ * @brief Retain accepted frames in a compact form for later re-rendering
+ *
+ * Frames that come from files are kept as a reference to the file, other frames are kept
+ * as in-memory JPEG. Frames are stored in calibration sample order
+ */
+class FrameArchive {
+public:
+    /**
+     * @brief Construct a new FrameArchive object
+     * @param jpeg_quality JPEG quality, 0-100, for frames kept in memory
+     */
+    explicit FrameArchive(int jpeg_quality = 95);
+
+    /**
+     * @brief Add a frame to the archive
+     * @param frame Clean frame without overlays
+     * @param path Path of the file the frame was loaded from, empty to keep the frame in memory
+     */
+    void add(const cv::Mat& frame, const std::string& path = "");
+
+    /**
+     * @brief Get the number of archived frames
+     * @return Number of frames
+     */
+    size_t size() const;
+
+    /**
+     * @brief Decode or load an archived frame
+     * @param i Frame index, in the order the frames were added
+     * @return Decoded frame, empty if it could not be loaded
+     */
+    cv::Mat get(size_t i) const;
+
+    /**
+     * @brief Get the memory held by in-memory frames
+     * @return Size of all encoded frames, in bytes
+     */
+    size_t get_memory_usage() const;
+
+    /**
+     * @brief Render the calibrated overlay on every archived frame and save them, in parallel
+     *
+     * Frame i is drawn with the extrinsics of calibration sample i, no pose is solved again
+     * @param directory Output directory, created if needed
+     * @param calibrator Calibrator with the intrinsics and per-view extrinsics of the archived frames
+     * @param board Chessboard model
+     * @param undistorter Undistort frames before drawing if not null
+     * @return Number of frames written
+     */
+    size_t export_overlays(const std::string& directory, const Calibrator& calibrator, const Chessboard& board,
+                           const Undistorter* undistorter = nullptr) const;
+
+private:
+    struct Entry {
+        std::string path;               // Source file, empty for in-memory frames
+        std::vector<uchar> encoded;     // JPEG data of in-memory frames
+    };
+
+    int jpeg_quality_;
+    std::vector<Entry> entries_;
+};
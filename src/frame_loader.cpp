@@ -1,11 +1,35 @@
 #include "frame_loader.hpp"
 
 #include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <filesystem>
+#include <iostream>
 
 #include <opencv2/opencv.hpp>
 
 
+/**
+ * @brief Create a frame loader from a source description
+ *
+ * A source made of digits only is a camera device index, anything else a directory
+ * @param source Camera device index, for example "0", or a directory of image files
+ * @return Camera loader for a numeric source, image sequence loader otherwise, nullptr for a device index out of range
+ */
+std::unique_ptr<FrameLoader> FrameLoader::create(const std::string& source) {
+    bool is_device = !source.empty() && std::all_of(source.begin(), source.end(), [](unsigned char c) { return std::isdigit(c); });
+    if (is_device) {
+        int device_id = 0;
+        auto [end, ec] = std::from_chars(source.data(), source.data() + source.size(), device_id);
+        if (ec != std::errc() || end != source.data() + source.size()) {
+            std::cerr << "Invalid camera device " << source << '\n';
+            return nullptr;
+        }
+        return std::make_unique<CameraFrameLoader>(device_id);
+    }
+    return std::make_unique<ImageSequenceLoader>(source);
+}
+
 /**
  * @brief Construct a CameraFrameLoader for a given device ID
  *
@@ -62,8 +86,9 @@ bool CameraFrameLoader::next_frame(cv::Mat& frame) {
  * Collect all regular files in the directory, sort them, and determine frame size from the first image
  */
 ImageSequenceLoader::ImageSequenceLoader(const std::string& directory) : current_idx_{0} {
-    // Collect all regular files in the directory
-    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    // Collect all regular files in the directory, a missing directory leaves the sequence empty
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
         if (entry.is_regular_file()) {
             filenames_.push_back(entry.path().string());
         }
@@ -94,3 +119,18 @@ bool ImageSequenceLoader::next_frame(cv::Mat& frame) {
     frame = cv::imread(filenames_[current_idx_++]);
     return !frame.empty(); // Return true if the image is loaded successfully
 }
+
+/**
+ * @brief Load an image by its position in the sequence, without advancing it, safe to call concurrently
+ * @param index Position in the sequence
+ * @param frame Output parameter to store the loaded image
+ * @return true if the image is successfully loaded, false if the index is out of range or on error
+ */
+bool ImageSequenceLoader::load_frame(size_t index, cv::Mat& frame) const {
+    if (index >= filenames_.size()) {
+        return false;
+    }
+
+    frame = cv::imread(filenames_[index]);
+    return !frame.empty();
+}
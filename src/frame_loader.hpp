@@ -39,6 +39,19 @@ public:
      * @return Number of frames, or -1 if unknown, for example live camera
      */
     virtual int get_num_frames() const = 0;
+
+    /**
+     * @brief Get the path of the file the last frame was loaded from
+     * @return File path, or empty if the source is not file-backed, for example live camera
+     */
+    virtual std::string get_frame_path() const { return std::string(); }
+
+    /**
+     * @brief Create a frame loader from a source description
+     * @param source Camera device index, for example "0", or a directory of image files
+     * @return Camera loader for a numeric source, image sequence loader otherwise, nullptr for a device index out of range
+     */
+    static std::unique_ptr<FrameLoader> create(const std::string& source);
 };
 
 /**
@@ -103,6 +116,23 @@ public:
      * @return Number of images, or -1 if unknown
      */
     int get_num_frames() const override { return static_cast<int>(filenames_.size()); }
+    /**
+     * @brief Get the path of the last loaded image
+     * @return File path, or empty if no image has been loaded yet
+     */
+    std::string get_frame_path() const override { return current_idx_ > 0 ? filenames_[current_idx_ - 1] : std::string(); }
+    /**
+     * @brief Get the paths of all images in the sequence, in load order
+     * @return Sorted file paths
+     */
+    const std::vector<std::string>& get_filenames() const { return filenames_; }
+    /**
+     * @brief Load an image by its position in the sequence, without advancing it, safe to call concurrently
+     * @param index Position in the sequence
+     * @param frame Output parameter to store the loaded image
+     * @return true if the image is successfully loaded, false if the index is out of range or on error
+     */
+    bool load_frame(size_t index, cv::Mat& frame) const;
 private:
     std::vector<std::string> filenames_; // List of image filenames
     size_t current_idx_ = 0;             // Current index in the sequence
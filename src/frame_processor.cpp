@@ -0,0 +1,245 @@
+#include "frame_processor.hpp"
+
+#include <iostream>
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "utils.hpp"
+
+
+constexpr double DEFAULT_FOCAL_LENGTH = 1000.0;   // Focal length of the camera matrix used before calibration
+constexpr double MAX_POSE_REPROJ_ERROR = 15.0;    // Reject poses with a larger mean reprojection error
+
+
+/**
+ * @brief Construct a new FrameProcessor object
+ * @param board Chessboard model used for detection and object points
+ * @param use_camera If true, use the blur threshold for live camera input
+ * @param verbose If true, print diagnostics for every A1 candidate
+ */
+FrameProcessor::FrameProcessor(const Chessboard& board, bool use_camera, bool verbose)
+    : board_(board), use_camera_(use_camera), verbose_(verbose) {}
+
+/**
+ * @brief Use calibrated intrinsics for the pose instead of the default camera matrix
+ * @param K Camera intrinsic matrix
+ * @param dist Camera distortion coefficients
+ */
+void FrameProcessor::set_intrinsics(const cv::Mat& K, const cv::Mat& dist) {
+    K_ = K.clone();
+    dist_ = dist.clone();
+    projector_ = Projection::Projector(K_, dist_);
+}
+
+/**
+ * @brief Evaluate the A1 candidates of a frame as stealable sub-tasks
+ * @param scheduler Scheduler for the sub-tasks, must outlive the processing, null to evaluate them in turn
+ */
+void FrameProcessor::set_scheduler(TaskScheduler* scheduler) {
+    scheduler_ = scheduler;
+}
+
+/**
+ * @brief Process a frame up to the pose of the chessboard
+ *
+ * Convert to grayscale, reject blurred frames, detect the corners, and select the A1 corner
+ * whose pose has the lowest reprojection error
+ * @param frame Input color frame, not modified
+ * @return Detection result, corners and pose are only set for accepted frames
+ */
+FrameResult FrameProcessor::process(const cv::Mat& frame) const {
+    FrameResult result;
+
+    // Convert to grayscale
+    cv::Mat gray;
+    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+
+    // Early return if blurred
+    result.sharpness = Utils::laplacian_variance(gray);
+    if (Utils::is_blurred(result.sharpness, use_camera_)) {
+        result.status = FrameStatus::Blurred;
+        return result;
+    }
+
+    // Find chessboard corners
+    std::vector<cv::Point2f> corners;
+    if (!board_.find_corners(gray, corners)) {
+        result.status = FrameStatus::NotFound;
+        return result;
+    }
+
+    // Try all possible A1 corners and find the best pose
+    find_best_pose(corners, gray, result);
+    return result;
+}
+
+/**
+ * @brief Get the chessboard model used by this processor
+ * @return Reference to the chessboard
+ */
+const Chessboard& FrameProcessor::get_board() const {
+    return board_;
+}
+
+/**
+ * @brief Create the default camera matrix used before calibration
+ * @param width Image width
+ * @param height Image height
+ * @return 3x3 camera matrix with a fixed focal length and the image center as principal point
+ */
+cv::Mat FrameProcessor::default_camera_matrix(int width, int height) {
+    cv::Mat K = cv::Mat::eye(3, 3, CV_64F);
+    K.at<double>(0, 0) = DEFAULT_FOCAL_LENGTH;
+    K.at<double>(1, 1) = DEFAULT_FOCAL_LENGTH;
+    K.at<double>(0, 2) = width / 2.0;
+    K.at<double>(1, 2) = height / 2.0;
+    return K;
+}
+
+/**
+ * @brief Get the message shown for a frame status
+ * @param status Frame status
+ * @return Human-readable message, empty for accepted frames
+ */
+std::string FrameProcessor::status_message(FrameStatus status) {
+    switch (status) {
+        case FrameStatus::Blurred:     return "Frame is blurred";
+        case FrameStatus::NotFound:    return "Chessboard not found";
+        case FrameStatus::InvalidPose: return "Pose not valid";
+        default:                       return "";
+    }
+}
+
+/**
+ * @brief Get the color used to show a frame status
+ * @param status Frame status
+ * @return BGR color
+ */
+cv::Scalar FrameProcessor::status_color(FrameStatus status) {
+    switch (status) {
+        case FrameStatus::Blurred:     return cv::Scalar(0,0,255);
+        case FrameStatus::NotFound:    return cv::Scalar(0,255,255);
+        case FrameStatus::InvalidPose: return cv::Scalar(0,165,255);
+        default:                       return cv::Scalar(0,255,0);
+    }
+}
+
+/**
+ * @brief Try all four A1 candidates and keep the pose with the lowest reprojection error
+ *
+ * For each candidate, reorder the corners, solve PnP with the default or calibrated intrinsics, and require
+ * the board normal to face the camera and a bounded reprojection error
+ * @param corners Detected corners in detection order
+ * @param gray Grayscale frame
+ * @param result Output result, status, corners, pose, A1 index, and reprojection error are set
+ */
+void FrameProcessor::find_best_pose(const std::vector<cv::Point2f>& corners, const cv::Mat& gray, FrameResult& result) const {
+    std::vector<int> a1_candidates = {0, 1, 2, 3};
+
+    int rows = board_.get_pattern_size().height;
+    int cols = board_.get_pattern_size().width;
+
+    cv::Point2f tl = corners[0];
+    cv::Point2f tr = corners[cols - 1];
+    cv::Point2f bl = corners[(rows - 1) * cols];
+    cv::Point2f br = corners[rows * cols - 1];
+    cv::Point2f dx = (tr - tl) / (cols - 1);
+    cv::Point2f dy = (bl - tl) / (rows - 1);
+
+    std::vector<cv::Point2f> outer_corners = {
+        tl - dx / 2 - dy / 2,
+        tr + dx / 2 - dy / 2,
+        bl - dx / 2 + dy / 2,
+        br + dx / 2 + dy / 2
+    };
+
+    std::vector<double> outer_vals(4, 1e6);
+    for (int i = 0; i < 4; ++i) {
+        auto pt = outer_corners[i];
+        if (pt.x < 2 || pt.y < 2 || pt.x > gray.cols - 3 || pt.y > gray.rows - 3) {
+            continue;
+        }
+        cv::Rect roi(pt - cv::Point2f(2,2), cv::Size(5,5));
+        outer_vals[i] = cv::mean(gray(roi))[0];
+    }
+
+    result.status = FrameStatus::InvalidPose;
+    result.reproj_error = 1e9;
+    result.a1_index = -1;
+
+    cv::Mat K = K_.empty() ? default_camera_matrix(gray.cols, gray.rows) : K_;
+    cv::Mat dist_coeffs = K_.empty() ? cv::Mat::zeros(5,1,CV_64F) : dist_;
+    Projection::Projector projector = K_.empty() ? Projection::Projector(K, cv::Mat()) : projector_;
+    auto obj_pts = board_.generate_object_points();
+
+    // Every candidate is evaluated on its own, possibly on another thread, into its own slot
+    struct Candidate {
+        std::vector<cv::Point2f> corners;
+        cv::Mat rvec, tvec;
+        bool pnp_ok = false;
+        bool z_ok = false;
+        double reproj_err = 1e9;
+    };
+    std::vector<Candidate> candidates(a1_candidates.size());
+    auto evaluate = [&](int c) {
+        Candidate& candidate = candidates[c];
+        candidate.corners = corners;
+        board_.reorder_corners(candidate.corners, a1_candidates[c]);
+
+        candidate.pnp_ok = cv::solvePnP(obj_pts, candidate.corners, K, dist_coeffs, candidate.rvec, candidate.tvec, false, cv::SOLVEPNP_ITERATIVE);
+
+        // Expand the pose once for the normal check and the reprojection
+        Projection::Pose pose;
+        if (candidate.pnp_ok) {
+            pose = Projection::make_pose(candidate.rvec, candidate.tvec);
+        }
+
+        candidate.z_ok = candidate.pnp_ok && (pose.R[8] > 0);
+        if (candidate.z_ok) {
+            std::vector<cv::Point2f> proj_pts(obj_pts.size());
+            projector.project(obj_pts.data(), obj_pts.size(), pose, proj_pts.data());
+            double err = 0.0;
+
+            for (size_t i = 0; i < proj_pts.size(); ++i) {
+                err += cv::norm(proj_pts[i] - candidate.corners[i]);
+            }
+
+            candidate.reproj_err = err / proj_pts.size();
+            if (candidate.reproj_err > MAX_POSE_REPROJ_ERROR) {
+                candidate.z_ok = false;
+            }
+        }
+    };
+    if (scheduler_) {
+        scheduler_->parallel_for(0, (int)candidates.size(), evaluate);
+    }
+    else {
+        for (int c = 0; c < (int)candidates.size(); ++c) {
+            evaluate(c);
+        }
+    }
+
+    // Select in candidate order, so the result does not depend on where the candidates ran
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        Candidate& candidate = candidates[c];
+        int a1_index = a1_candidates[c];
+
+        if (verbose_) {
+            std::cout << "A1 candidate " << a1_index
+                      << ": pixel value=" << outer_vals[a1_index]
+                      << ", solvePnP=" << (candidate.pnp_ok ? "true" : "false")
+                      << ", z_outwards=" << (candidate.z_ok ? "true" : "false")
+                      << ", reprojErr=" << candidate.reproj_err << (candidate.z_ok ? " (OK)" : " (FAIL)") << '\n';
+        }
+
+        if (candidate.z_ok && candidate.reproj_err < result.reproj_error) {
+            result.status = FrameStatus::Accepted;
+            result.reproj_error = candidate.reproj_err;
+            result.a1_index = a1_index;
+            result.corners = std::move(candidate.corners);
+            result.rvec = candidate.rvec;
+            result.tvec = candidate.tvec;
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "chessboard.hpp"
+#include "projection.hpp"
+#include "task_scheduler.hpp"
+
+
+/**
+ * @brief Outcome of processing a single frame
+ */
+enum class FrameStatus {
+    Accepted,       // Chessboard found with a valid pose
+    Blurred,        // Rejected by the blur check
+    NotFound,       // No chessboard corners found
+    InvalidPose     // Corners found but no A1 candidate gave a valid pose
+};
+
+/**
+ * @brief Detection and pose of a single frame
+ */
+struct FrameResult {
+    FrameStatus status = FrameStatus::NotFound;
+    double sharpness = 0.0;              // Laplacian variance of the frame
+    int a1_index = -1;                   // Outer corner used as A1, 0=TL, 1=TR, 2=BL, 3=BR
+    double reproj_error = 1e9;           // Mean reprojection error of the best pose, in pixels
+    std::vector<cv::Point2f> corners;    // Detected corners in A1 order
+    cv::Mat rvec;                        // Board rotation, Rodrigues, for the default or calibrated intrinsics
+    cv::Mat tvec;                        // Board translation, for the default or calibrated intrinsics
+
+    /**
+     * @brief Check if the frame can be used as a calibration sample
+     * @return true if the status is Accepted
+     */
+    bool accepted() const { return status == FrameStatus::Accepted; }
+};
+
+/**
+ * @class FrameProcessor
+ * @brief Run the per-frame stages: grayscale, blur check, chessboard detection, and pose selection
+ *
+ * Processing does not modify any state, so one processor can be shared by several threads. With a
+ * scheduler, the A1 candidates of a frame are evaluated as sub-tasks that idle threads can steal
+ */
+class FrameProcessor {
+public:
+    /**
+     * @brief Construct a new FrameProcessor object
+     * @param board Chessboard model used for detection and object points
+     * @param use_camera If true, use the blur threshold for live camera input
+     * @param verbose If true, print diagnostics for every A1 candidate
+     */
+    FrameProcessor(const Chessboard& board, bool use_camera, bool verbose = false);
+
+    /**
+     * @brief Use calibrated intrinsics for the pose instead of the default camera matrix
+     * @param K Camera intrinsic matrix
+     * @param dist Camera distortion coefficients
+     */
+    void set_intrinsics(const cv::Mat& K, const cv::Mat& dist);
+
+    /**
+     * @brief Evaluate the A1 candidates of a frame as stealable sub-tasks
+     * @param scheduler Scheduler for the sub-tasks, must outlive the processing, null to evaluate them in turn
+     */
+    void set_scheduler(TaskScheduler* scheduler);
+
+    /**
+     * @brief Process a frame up to the pose of the chessboard
+     * @param frame Input color frame, not modified
+     * @return Detection result, corners and pose are only set for accepted frames
+     */
+    FrameResult process(const cv::Mat& frame) const;
+
+    /**
+     * @brief Get the chessboard model used by this processor
+     * @return Reference to the chessboard
+     */
+    const Chessboard& get_board() const;
+
+    /**
+     * @brief Create the default camera matrix used before calibration
+     * @param width Image width
+     * @param height Image height
+     * @return 3x3 camera matrix with a fixed focal length and the image center as principal point
+     */
+    static cv::Mat default_camera_matrix(int width, int height);
+
+    /**
+     * @brief Get the message shown for a frame status
+     * @param status Frame status
+     * @return Human-readable message, empty for accepted frames
+     */
+    static std::string status_message(FrameStatus status);
+
+    /**
+     * @brief Get the color used to show a frame status
+     * @param status Frame status
+     * @return BGR color
+     */
+    static cv::Scalar status_color(FrameStatus status);
+
+private:
+    /**
+     * @brief Try all four A1 candidates and keep the pose with the lowest reprojection error
+     * @param corners Detected corners in detection order
+     * @param gray Grayscale frame
+     * @param result Output result, status, corners, pose, A1 index, and reprojection error are set
+     */
+    void find_best_pose(const std::vector<cv::Point2f>& corners, const cv::Mat& gray, FrameResult& result) const;
+
+    Chessboard board_;
+    bool use_camera_;
+    bool verbose_;
+
+    cv::Mat K_;       // Calibrated camera matrix, empty to use the default
+    cv::Mat dist_;    // Calibrated distortion coefficients
+    Projection::Projector projector_;   // Kernel for the calibrated intrinsics, selected once
+    TaskScheduler* scheduler_ = nullptr;  // Scheduler for the candidate sub-tasks, null to run them in turn
+};
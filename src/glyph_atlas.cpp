@@ -0,0 +1,164 @@
+#include "glyph_atlas.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include <opencv2/imgproc.hpp>
+
+
+constexpr int FONT_FACE = cv::FONT_HERSHEY_SIMPLEX;
+
+
+/**
+ * @brief Rasterize the printable ASCII range with FONT_HERSHEY_SIMPLEX and anti-aliasing
+ *
+ * All glyphs share one cell height and are laid out in a single row
+ * @param scale Font scale, as for cv::putText
+ * @param thickness Stroke thickness, as for cv::putText
+ */
+GlyphAtlas::GlyphAtlas(double scale, int thickness) {
+    std::string all;
+    for (int c = 0; c < NUM_CHARS; ++c) {
+        all += (char)(FIRST_CHAR + c);
+    }
+    int baseline = 0;
+    cv::Size extent = cv::getTextSize(all, FONT_FACE, scale, thickness, &baseline);
+
+    pad_ = thickness + 2;
+    ascent_ = extent.height + pad_;
+    int cell_height = ascent_ + baseline + pad_;
+
+    // Measure every glyph, getTextSize includes the thickness once
+    int x = 0;
+    for (int c = 0; c < NUM_CHARS; ++c) {
+        int advance = cv::getTextSize(std::string(1, (char)(FIRST_CHAR + c)), FONT_FACE, scale, thickness, nullptr).width - thickness;
+        glyphs_[c].advance = std::max(advance, 0);
+        glyphs_[c].cell = cv::Rect(x, 0, glyphs_[c].advance + 2 * pad_, cell_height);
+        x += glyphs_[c].cell.width;
+    }
+
+    // Rasterize every glyph into its cell
+    atlas_ = cv::Mat::zeros(cell_height, x, CV_8U);
+    for (int c = 0; c < NUM_CHARS; ++c) {
+        cv::Mat cell = atlas_(glyphs_[c].cell);
+        cv::putText(cell, std::string(1, (char)(FIRST_CHAR + c)), cv::Point(pad_, ascent_),
+                    FONT_FACE, scale, cv::Scalar(255), thickness, cv::LINE_AA);
+    }
+}
+
+/**
+ * @brief Blend text into an image, placed like cv::putText
+ *
+ * Blend each covered pixel with integer arithmetic, fully covered pixels are written directly
+ * @param image 8-bit BGR or BGRA image on which to draw, BGRA alpha is raised to the glyph coverage
+ * @param text Text to draw, characters outside printable ASCII are drawn as '?'
+ * @param origin Bottom-left corner of the text
+ * @param color Text color
+ */
+void GlyphAtlas::draw(cv::Mat& image, const std::string& text, cv::Point origin, cv::Scalar color) const {
+    CV_Assert(image.depth() == CV_8U && (image.channels() == 3 || image.channels() == 4));
+    const int cn = image.channels();
+    const int bgr[3] = { cv::saturate_cast<uchar>(color[0]), cv::saturate_cast<uchar>(color[1]), cv::saturate_cast<uchar>(color[2]) };
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+
+    int pen_x = origin.x;
+    for (char ch : text) {
+        int c = (unsigned char)ch - FIRST_CHAR;
+        if (c < 0 || c >= NUM_CHARS) {
+            c = '?' - FIRST_CHAR;
+        }
+        const Glyph& glyph = glyphs_[c];
+
+        cv::Rect target(pen_x - pad_, origin.y - ascent_, glyph.cell.width, glyph.cell.height);
+        cv::Rect clipped = target & bounds;
+        pen_x += glyph.advance;
+        if (clipped.empty()) {
+            continue;
+        }
+
+        int src_x = glyph.cell.x + clipped.x - target.x;
+        int src_y = glyph.cell.y + clipped.y - target.y;
+        for (int y = 0; y < clipped.height; ++y) {
+            const uchar* coverage = atlas_.ptr<uchar>(src_y + y) + src_x;
+            uchar* dst = image.ptr<uchar>(clipped.y + y) + clipped.x * cn;
+            for (int i = 0; i < clipped.width; ++i, dst += cn) {
+                int a = coverage[i];
+                if (a == 0) {
+                    continue;
+                }
+                if (a == 255) {
+                    dst[0] = (uchar)bgr[0];
+                    dst[1] = (uchar)bgr[1];
+                    dst[2] = (uchar)bgr[2];
+                }
+                else {
+                    for (int k = 0; k < 3; ++k) {
+                        dst[k] = (uchar)((dst[k] * (255 - a) + bgr[k] * a + 127) / 255);
+                    }
+                }
+                if (cn == 4) {
+                    dst[3] = (uchar)std::max<int>(dst[3], a);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get the size of a text in pixels, without the part below the baseline
+ * @param text Text to measure
+ * @return Width and height of the text
+ */
+cv::Size GlyphAtlas::get_text_size(const std::string& text) const {
+    int width = 0;
+    for (char ch : text) {
+        int c = (unsigned char)ch - FIRST_CHAR;
+        width += glyphs_[(c < 0 || c >= NUM_CHARS) ? '?' - FIRST_CHAR : c].advance;
+    }
+    return cv::Size(width, ascent_ - pad_);
+}
+
+/**
+ * @brief Get the region a text covers when drawn, including anti-aliased edges and descenders
+ * @param text Text to measure
+ * @param origin Bottom-left corner of the text
+ * @return Covered region in image coordinates
+ */
+cv::Rect GlyphAtlas::get_bounds(const std::string& text, cv::Point origin) const {
+    return cv::Rect(origin.x - pad_, origin.y - ascent_, get_text_size(text).width + 2 * pad_, atlas_.rows);
+}
+
+/**
+ * @brief Get the shared atlas of a font scale and thickness, rasterized on first use
+ *
+ * Lookups of existing atlases share the lock, so threads drawing text concurrently do not wait on
+ * each other; only the first use of a scale and thickness takes the lock exclusively to rasterize
+ * @param scale Font scale, as for cv::putText
+ * @param thickness Stroke thickness, as for cv::putText
+ * @return Reference to the atlas, valid for the lifetime of the program
+ */
+const GlyphAtlas& GlyphAtlas::get(double scale, int thickness) {
+    static std::shared_mutex mutex;
+    static std::map<std::pair<int, int>, std::unique_ptr<GlyphAtlas>> atlases;
+
+    std::pair<int, int> key((int)std::lround(scale * 1000.0), thickness);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = atlases.find(key);
+        if (it != atlases.end()) {
+            return *it->second;
+        }
+    }
+
+    // Another thread may have rasterized it between the locks
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto& atlas = atlases[key];
+    if (!atlas) {
+        atlas = std::make_unique<GlyphAtlas>(scale, thickness);
+    }
+    return *atlas;
+}
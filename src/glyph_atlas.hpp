@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+
+/**
+ * @class GlyphAtlas
+ * @brief Pre-rasterized printable ASCII glyphs of one font scale and thickness
+ *
+ * Glyphs are drawn once with cv::putText into an 8-bit coverage atlas and then alpha-blended
+ * into the target image, which avoids rasterizing Hershey strokes on every frame.
+ * Atlases are immutable after construction, so drawing from several threads is safe
+ */
+class GlyphAtlas {
+public:
+    /**
+     * @brief Rasterize the printable ASCII range with FONT_HERSHEY_SIMPLEX and anti-aliasing
+     * @param scale Font scale, as for cv::putText
+     * @param thickness Stroke thickness, as for cv::putText
+     */
+    GlyphAtlas(double scale, int thickness);
+
+    /**
+     * @brief Blend text into an image, placed like cv::putText
+     * @param image 8-bit BGR or BGRA image on which to draw, BGRA alpha is raised to the glyph coverage
+     * @param text Text to draw, characters outside printable ASCII are drawn as '?'
+     * @param origin Bottom-left corner of the text
+     * @param color Text color
+     */
+    void draw(cv::Mat& image, const std::string& text, cv::Point origin, cv::Scalar color) const;
+
+    /**
+     * @brief Get the size of a text in pixels, without the part below the baseline
+     * @param text Text to measure
+     * @return Width and height of the text
+     */
+    cv::Size get_text_size(const std::string& text) const;
+
+    /**
+     * @brief Get the region a text covers when drawn, including anti-aliased edges and descenders
+     * @param text Text to measure
+     * @param origin Bottom-left corner of the text
+     * @return Covered region in image coordinates
+     */
+    cv::Rect get_bounds(const std::string& text, cv::Point origin) const;
+
+    /**
+     * @brief Get the shared atlas of a font scale and thickness, rasterized on first use
+     * @param scale Font scale, as for cv::putText
+     * @param thickness Stroke thickness, as for cv::putText
+     * @return Reference to the atlas, valid for the lifetime of the program
+     */
+    static const GlyphAtlas& get(double scale, int thickness);
+
+private:
+    static constexpr int FIRST_CHAR = 32;
+    static constexpr int NUM_CHARS = 95;
+
+    /**
+     * @brief Location of one glyph in the atlas
+     */
+    struct Glyph {
+        cv::Rect cell;   // Cell in the atlas, the pen position is at (pad_, ascent_) inside it
+        int advance;     // Horizontal pen advance in pixels
+    };
+
+    cv::Mat atlas_;             // Coverage of all glyphs, CV_8U
+    Glyph glyphs_[NUM_CHARS];
+    int ascent_ = 0;            // Distance from the cell top to the baseline
+    int pad_ = 0;               // Margin around every glyph for strokes that overhang the advance
+};
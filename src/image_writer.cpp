@@ -0,0 +1,182 @@
+#include "image_writer.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+
+constexpr unsigned MAX_THREADS = 4;       // Encoding is memory bound beyond a few threads
+
+
+/**
+ * @brief Construct a new ImageWriter object and start the pool
+ * @param format File extension without the dot: png, jpg, or webp
+ * @param level Compression level, 0-9 for png, quality 0-100 for jpg and webp, negative for the default
+ * @param max_bytes Largest total size of the queued images
+ * @param threads Number of encoder threads, 0 for about half the hardware threads
+ */
+ImageWriter::ImageWriter(const std::string& format, int level, size_t max_bytes, unsigned threads)
+    : format_(format), max_bytes_(max_bytes)
+{
+    if (format_ == "jpeg") {
+        format_ = "jpg";
+    }
+    if (format_ != "png" && format_ != "jpg" && format_ != "webp") {
+        std::cerr << "Unknown image format " << format << ", using png." << '\n';
+        format_ = "png";
+    }
+
+    if (level >= 0) {
+        if (format_ == "png") {
+            params_ = { cv::IMWRITE_PNG_COMPRESSION, std::min(level, 9) };
+        }
+        else if (format_ == "jpg") {
+            params_ = { cv::IMWRITE_JPEG_QUALITY, std::min(level, 100) };
+        }
+        else {
+            params_ = { cv::IMWRITE_WEBP_QUALITY, std::max(1, std::min(level, 100)) };
+        }
+    }
+
+    if (threads == 0) {
+        threads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, MAX_THREADS);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.emplace_back(&ImageWriter::run, this);
+    }
+}
+
+/**
+ * @brief Save the queued images and stop the pool
+ */
+ImageWriter::~ImageWriter() {
+    close();
+}
+
+/**
+ * @brief Queue an image for saving, the image data is shared, not copied
+ *
+ * An image larger than the whole budget is still accepted when nothing else is queued
+ * @param path Output file, should end with the extension of the configured format
+ * @param image Image to save, must not be modified afterwards, pass a clone of a reused buffer
+ * @param wait If true, wait for room in the queue instead of dropping the image
+ * @return true if the image was queued, false if it was dropped
+ */
+bool ImageWriter::write(const std::string& path, const cv::Mat& image, bool wait) {
+    const size_t bytes = image.total() * image.elemSize();
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto has_room = [&]() { return queued_bytes_ == 0 || queued_bytes_ + bytes <= max_bytes_; };
+    if (wait) {
+        room_.wait(lock, [&]() { return !running_ || has_room(); });
+    }
+    if (!running_ || !has_room()) {
+        ++dropped_;
+        return false;
+    }
+    queued_bytes_ += bytes;
+    jobs_.push_back(Job{ path, image });
+    lock.unlock();
+    ready_.notify_one();
+    return true;
+}
+
+/**
+ * @brief Wait until all queued images are saved
+ */
+void ImageWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    room_.wait(lock, [&]() { return queued_bytes_ == 0; });
+}
+
+/**
+ * @brief Save the queued images and stop the pool, later images are dropped
+ */
+void ImageWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    ready_.notify_all();
+    room_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+/**
+ * @brief Get the file extension of the configured format
+ * @return Extension without the dot
+ */
+const std::string& ImageWriter::get_format() const {
+    return format_;
+}
+
+/**
+ * @brief Get the number of images saved
+ * @return Number of saved images
+ */
+uint64_t ImageWriter::get_written() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return written_;
+}
+
+/**
+ * @brief Get the number of images dropped because the queue was full
+ * @return Number of dropped images
+ */
+uint64_t ImageWriter::get_dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+/**
+ * @brief Get the number of images that could not be encoded or written
+ * @return Number of failed images
+ */
+uint64_t ImageWriter::get_failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+}
+
+/**
+ * @brief Pool thread loop, save jobs until stopped and the queue is empty
+ *
+ * The budget of an image is released only after it is written, so encoding buffers count too
+ */
+void ImageWriter::run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [&]() { return !jobs_.empty() || !running_; });
+            if (jobs_.empty()) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        bool ok = false;
+        try {
+            ok = cv::imwrite(job.path, job.image, params_);
+        }
+        catch (const cv::Exception& e) {
+            std::cerr << "Could not save " << job.path << ": " << e.what() << '\n';
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_bytes_ -= job.image.total() * job.image.elemSize();
+            if (ok) {
+                ++written_;
+            }
+            else {
+                ++failed_;
+            }
+        }
+        room_.notify_all();
+        ready_.notify_all();
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+
+/**
+ * @class ImageWriter
+ * @brief Encode and save images on a small pool of background threads
+ *
+ * Images are queued without a copy, in a queue bounded in bytes, and encoded by the pool, so saving
+ * large frames does not slow the caller. When the queue is full an image is either dropped and counted,
+ * or the caller waits for room, chosen per image. All images share one format and compression level
+ */
+class ImageWriter {
+public:
+    /**
+     * @brief Construct a new ImageWriter object and start the pool
+     * @param format File extension without the dot: png, jpg, or webp
+     * @param level Compression level, 0-9 for png, quality 0-100 for jpg and webp, negative for the default
+     * @param max_bytes Largest total size of the queued images
+     * @param threads Number of encoder threads, 0 for about half the hardware threads
+     */
+    ImageWriter(const std::string& format = "png", int level = -1, size_t max_bytes = 256u << 20, unsigned threads = 0);
+
+    /**
+     * @brief Save the queued images and stop the pool
+     */
+    ~ImageWriter();
+
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator=(const ImageWriter&) = delete;
+
+    /**
+     * @brief Queue an image for saving, the image data is shared, not copied
+     * @param path Output file, should end with the extension of the configured format
+     * @param image Image to save, must not be modified afterwards, pass a clone of a reused buffer
+     * @param wait If true, wait for room in the queue instead of dropping the image
+     * @return true if the image was queued, false if it was dropped
+     */
+    bool write(const std::string& path, const cv::Mat& image, bool wait = false);
+
+    /**
+     * @brief Wait until all queued images are saved
+     */
+    void flush();
+
+    /**
+     * @brief Save the queued images and stop the pool, later images are dropped
+     */
+    void close();
+
+    /**
+     * @brief Get the file extension of the configured format
+     * @return Extension without the dot
+     */
+    const std::string& get_format() const;
+
+    /**
+     * @brief Get the number of images saved
+     * @return Number of saved images
+     */
+    uint64_t get_written() const;
+
+    /**
+     * @brief Get the number of images dropped because the queue was full
+     * @return Number of dropped images
+     */
+    uint64_t get_dropped() const;
+
+    /**
+     * @brief Get the number of images that could not be encoded or written
+     * @return Number of failed images
+     */
+    uint64_t get_failed() const;
+
+private:
+    /**
+     * @brief Image waiting to be saved
+     */
+    struct Job {
+        std::string path;
+        cv::Mat image;
+    };
+
+    /**
+     * @brief Pool thread loop, save jobs until stopped and the queue is empty
+     */
+    void run();
+
+    std::string format_;
+    std::vector<int> params_;       // cv::imwrite parameters of the format and level
+    size_t max_bytes_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;     // A job was queued or the pool is stopping
+    std::condition_variable room_;      // A job was taken or finished
+    std::deque<Job> jobs_;
+    size_t queued_bytes_ = 0;           // Size of the images queued or being encoded
+    bool running_ = true;
+    uint64_t written_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t failed_ = 0;
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,174 @@
+#include "instanced_mesh.hpp"
+
+#include <algorithm>
+
+#include <opencv2/imgproc.hpp>
+
+
+constexpr double NEAR_DEPTH = 1e-3;   // Instances with a vertex closer to the camera plane are culled
+
+
+/**
+ * @brief Create a cube with its base corner at the origin
+ * @param size Edge length
+ * @return Cube mesh, 8 vertices and 12 edges
+ */
+Mesh Mesh::cube(float size) {
+    const float s = size;
+    Mesh mesh;
+    mesh.vertices = {
+        {0, 0, 0}, {0, s, 0}, {s, 0, 0}, {0, 0, -s},
+        {s, s, 0}, {0, s, -s}, {s, 0, -s}, {s, s, -s}
+    };
+    mesh.edges = {
+        {0,1}, {1,4}, {4,2}, {2,0},   // Bottom face
+        {3,5}, {5,7}, {7,6}, {6,3},   // Top face
+        {0,3}, {1,5}, {2,6}, {4,7}    // Verticals
+    };
+    return mesh;
+}
+
+/**
+ * @brief Create a square pyramid standing on the board, centered on the origin
+ * @param size Base edge length
+ * @param height Height of the apex above the board
+ * @return Pyramid mesh, 5 vertices and 8 edges
+ */
+Mesh Mesh::pyramid(float size, float height) {
+    const float h = size / 2;
+    Mesh mesh;
+    mesh.vertices = { {-h, -h, 0}, {h, -h, 0}, {h, h, 0}, {-h, h, 0}, {0, 0, -height} };
+    mesh.edges = { {0,1}, {1,2}, {2,3}, {3,0}, {0,4}, {1,4}, {2,4}, {3,4} };
+    return mesh;
+}
+
+/**
+ * @brief Create a flat crossed-square marker on the board, centered on the origin
+ * @param size Edge length
+ * @return Marker mesh, 4 vertices and 6 edges
+ */
+Mesh Mesh::marker(float size) {
+    const float h = size / 2;
+    Mesh mesh;
+    mesh.vertices = { {-h, -h, 0}, {h, -h, 0}, {h, h, 0}, {-h, h, 0} };
+    mesh.edges = { {0,1}, {1,2}, {2,3}, {3,0}, {0,2}, {1,3} };
+    return mesh;
+}
+
+/**
+ * @brief Construct a new InstancedMesh object
+ * @param mesh Mesh shared by all instances
+ */
+InstancedMesh::InstancedMesh(const Mesh& mesh) : mesh_(mesh) {}
+
+/**
+ * @brief Add an instance
+ *
+ * The instance is inserted after the last instance of the same color, so every color forms one
+ * contiguous run and costs one polyline call however the colors alternate, e.g. on a checkered pattern
+ * @param placement Position, scale, and color of the instance
+ */
+void InstancedMesh::add(const Placement& placement) {
+    auto same_color = std::find_if(placements_.rbegin(), placements_.rend(),
+                                   [&placement](const Placement& other) { return other.color == placement.color; });
+    size_t index = (size_t)(placements_.rend() - same_color);
+    if (same_color == placements_.rend()) {
+        index = placements_.size();
+    }
+
+    std::vector<cv::Point3f> vertices;
+    vertices.reserve(mesh_.vertices.size());
+    for (const auto& v : mesh_.vertices) {
+        vertices.push_back(placement.position + v * placement.scale);
+    }
+    placements_.insert(placements_.begin() + index, placement);
+    vertices_.insert(vertices_.begin() + index * mesh_.vertices.size(), vertices.begin(), vertices.end());
+}
+
+/**
+ * @brief Remove all instances
+ */
+void InstancedMesh::clear() {
+    placements_.clear();
+    vertices_.clear();
+}
+
+/**
+ * @brief Get the number of instances
+ * @return Number of instances
+ */
+size_t InstancedMesh::size() const {
+    return placements_.size();
+}
+
+/**
+ * @brief Project all instances with one pose and draw the visible ones
+ *
+ * Depth is taken from the third row of the rotation, so the near-plane test costs one dot product
+ * per vertex. An instance is kept if all its vertices are in front of the camera and the bounding
+ * box of its projection overlaps the image
+ * @param image Image on which to draw
+ * @param projector Projection kernel of the camera
+ * @param rvec Rotation vector, Rodrigues
+ * @param tvec Translation vector
+ * @param thickness Edge thickness in pixels
+ * @return Number of instances drawn after culling
+ */
+size_t InstancedMesh::render(cv::Mat& image, const Projection::Projector& projector,
+                             const cv::Mat& rvec, const cv::Mat& tvec, int thickness) const
+{
+    if (vertices_.empty()) {
+        return 0;
+    }
+
+    Projection::Pose pose = Projection::make_pose(rvec, tvec);
+    std::vector<cv::Point2f> proj(vertices_.size());
+    projector.project_fast(vertices_.data(), vertices_.size(), pose, proj.data());
+
+    const size_t n = mesh_.vertices.size();
+    const cv::Rect2f bounds(0.0f, 0.0f, (float)image.cols, (float)image.rows);
+    const double* r = pose.R + 6;
+
+    size_t drawn = 0;
+    std::vector<std::vector<cv::Point>> segments;
+    cv::Scalar run_color;
+
+    // Draw the collected segments of one color, its instances are contiguous
+    auto flush = [&]() {
+        if (!segments.empty()) {
+            cv::polylines(image, segments, false, cv::Scalar(run_color[0], run_color[1], run_color[2], 255), thickness);
+            segments.clear();
+        }
+    };
+
+    for (size_t i = 0; i < placements_.size(); ++i) {
+        const cv::Point3f* v = &vertices_[i * n];
+        const cv::Point2f* p = &proj[i * n];
+
+        // Near-plane and image-bounds culling
+        bool in_front = true;
+        float min_x = p[0].x, max_x = p[0].x, min_y = p[0].y, max_y = p[0].y;
+        for (size_t k = 0; k < n && in_front; ++k) {
+            in_front = r[0] * v[k].x + r[1] * v[k].y + r[2] * v[k].z + pose.t[2] > NEAR_DEPTH;
+            min_x = std::min(min_x, p[k].x);
+            max_x = std::max(max_x, p[k].x);
+            min_y = std::min(min_y, p[k].y);
+            max_y = std::max(max_y, p[k].y);
+        }
+        if (!in_front || (bounds & cv::Rect2f(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1)).empty()) {
+            continue;
+        }
+
+        if (placements_[i].color != run_color) {
+            flush();
+            run_color = placements_[i].color;
+        }
+        for (const auto& e : mesh_.edges) {
+            segments.push_back({ cv::Point(cvRound(p[e.first].x), cvRound(p[e.first].y)),
+                                 cv::Point(cvRound(p[e.second].x), cvRound(p[e.second].y)) });
+        }
+        ++drawn;
+    }
+    flush();
+    return drawn;
+}
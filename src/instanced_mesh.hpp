@@ -0,0 +1,100 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "projection.hpp"
+
+
+/**
+ * @brief Wireframe mesh in local coordinates, shared by all instances
+ */
+struct Mesh {
+    std::vector<cv::Point3f> vertices;          // Local vertices, Z negative points away from the board
+    std::vector<std::pair<int, int>> edges;     // Vertex index pairs
+
+    /**
+     * @brief Create a cube with its base corner at the origin
+     * @param size Edge length
+     * @return Cube mesh, 8 vertices and 12 edges
+     */
+    static Mesh cube(float size = 1.0f);
+
+    /**
+     * @brief Create a square pyramid standing on the board, centered on the origin
+     * @param size Base edge length
+     * @param height Height of the apex above the board
+     * @return Pyramid mesh, 5 vertices and 8 edges
+     */
+    static Mesh pyramid(float size = 1.0f, float height = 1.0f);
+
+    /**
+     * @brief Create a flat crossed-square marker on the board, centered on the origin
+     * @param size Edge length
+     * @return Marker mesh, 4 vertices and 6 edges
+     */
+    static Mesh marker(float size = 0.5f);
+};
+
+/**
+ * @brief Placement of one instance of a mesh, board coordinates
+ */
+struct Placement {
+    cv::Point3f position;                    // Position of the mesh origin
+    float scale = 1.0f;                      // Uniform scale of the mesh
+    cv::Scalar color = cv::Scalar(255,255,255);
+};
+
+/**
+ * @class InstancedMesh
+ * @brief Draw many placements of one wireframe mesh with a single batched projection
+ *
+ * The vertices of all instances are expanded once when instances are added. Rendering projects
+ * them all in one call, culls instances behind the camera or entirely outside the image, and draws
+ * the remaining edges with one polyline call per color. Instances are grouped by color as they are
+ * added, in insertion order within a color
+ */
+class InstancedMesh {
+public:
+    /**
+     * @brief Construct a new InstancedMesh object
+     * @param mesh Mesh shared by all instances
+     */
+    explicit InstancedMesh(const Mesh& mesh);
+
+    /**
+     * @brief Add an instance, after the instances of the same color
+     * @param placement Position, scale, and color of the instance
+     */
+    void add(const Placement& placement);
+
+    /**
+     * @brief Remove all instances
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of instances
+     * @return Number of instances
+     */
+    size_t size() const;
+
+    /**
+     * @brief Project all instances with one pose and draw the visible ones
+     * @param image Image on which to draw
+     * @param projector Projection kernel of the camera
+     * @param rvec Rotation vector, Rodrigues
+     * @param tvec Translation vector
+     * @param thickness Edge thickness in pixels
+     * @return Number of instances drawn after culling
+     */
+    size_t render(cv::Mat& image, const Projection::Projector& projector,
+                  const cv::Mat& rvec, const cv::Mat& tvec, int thickness = 2) const;
+
+private:
+    Mesh mesh_;
+    std::vector<Placement> placements_;
+    std::vector<cv::Point3f> vertices_;   // Board coordinates of every instance vertex, instance-major
+};
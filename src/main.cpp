@@ -1,5 +1,13 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <iostream>
 
@@ -7,34 +15,724 @@
 
 #include "utils.hpp"
 #include "renderer.hpp"
+#include "batch_calibrator.hpp"
 #include "calibrator.hpp"
 #include "chessboard.hpp"
+#include "corner_store.hpp"
+#include "display_thread.hpp"
+#include "frame_archive.hpp"
 #include "frame_loader.hpp"
+#include "frame_processor.hpp"
+#include "image_writer.hpp"
+#include "instanced_mesh.hpp"
+#include "options.hpp"
+#include "overlay_layer.hpp"
+#include "overlay_scene.hpp"
+#include "pipeline.hpp"
+#include "pose_publisher.hpp"
+#include "preview_scaler.hpp"
+#include "projection.hpp"
+#include "rig_calibrator.hpp"
+#include "stereo_calibrator.hpp"
+#include "task_scheduler.hpp"
+#include "thread_budget.hpp"
+#include "thread_placement.hpp"
+#include "undistorter.hpp"
+#include "video_recorder.hpp"
 
 
 constexpr int CORNERS_X = 7;
 constexpr int CORNERS_Y = 7;
 constexpr int KEY_ESCAPE = 27;
-constexpr int REQUIRED_FRAMES = 12;
+constexpr unsigned MAX_DETECT_WORKERS = 4;  // Detection workers of the tracking pipeline
+constexpr unsigned TRACKING_RESERVED_THREADS = 2;  // Render stage and sink of the tracking pipeline
+constexpr int SAMPLE_INTERVAL_MS = 1000;   // Shortest time between camera samples, so they do not repeat one view
+constexpr int PREVIEW_WIDTH = 1280;    // Window size, live previews are downsampled to fit
+constexpr int PREVIEW_HEIGHT = 720;
 constexpr float SQUARE_SIZE = 1.0f;
 constexpr const char* WINDOW_NAME = "Checkmate";
 
 
-struct FrameCorners {
-    std::vector<cv::Point2f> a1;
-    std::vector<cv::Point2f> h8;
+/**
+ * @brief Calibrate offline from a corner store of earlier sessions
+ * @param options Session options, resolve_dir and resolve_max are used
+ * @return Process exit code
+ */
+static int resolve_from_store(const Options& options) {
+    CornerStoreReader store(options.resolve_dir);
+    if (!store.is_opened() || store.size() == 0) {
+        std::cerr << "No detections found in corner store " << options.resolve_dir << '\n';
+        return -1;
+    }
+
+    // All samples share one set of object points
+    Chessboard detector(CORNERS_X, CORNERS_Y, SQUARE_SIZE);
+    cv::Mat object_pts(detector.generate_object_points(), true);
+
+    Calibrator calibrator;
+    size_t count = store.load_into(calibrator, object_pts, (size_t)std::max(options.resolve_max, 0));
+    std::cout << "Loaded " << count << " of " << store.size() << " detections from " << options.resolve_dir << '\n';
+
+    if (!calibrator.calibrate(store.get_image_size())) {
+        std::cerr << "Calibration failed." << '\n';
+        return -1;
+    }
+
+    std::string calibration_filename = Utils::filename_timestamp("calibration", "yml");
+    calibrator.save(calibration_filename);
+    std::cout << "Reprojection error: " << calibrator.get_reproj_error() << '\n';
+    std::cout << "Calibration saved as " << calibration_filename << std::endl;
+    return 0;
+}
+
+
+/**
+ * @brief Calibrate a stereo pair, detecting on both views in parallel
+ *
+ * Each iteration grabs and processes the right view on a worker thread while the current thread
+ * handles the left view, so a pair costs about as much as a single frame. Only pairs where both
+ * views are accepted are used for calibration
+ * @param options Session options, stereo_sources holds the left and right source
+ * @return Process exit code
+ */
+static int run_stereo(const Options& options) {
+    auto left = FrameLoader::create(options.stereo_sources[0]);
+    auto right = FrameLoader::create(options.stereo_sources[1]);
+    if (!left || !right || !left->is_opened() || !right->is_opened()) {
+        std::cerr << "Could not open stereo sources " << options.stereo_sources[0] << " and " << options.stereo_sources[1] << '\n';
+        return -1;
+    }
+
+    // Rectification maps both views to one image size, check before capturing any pair
+    if (left->get_frame_size() != right->get_frame_size()) {
+        std::cerr << "Stereo sources differ in frame size, " << left->get_frame_size() << " and " << right->get_frame_size()
+                  << ", both cameras must deliver the same size." << '\n';
+        return -1;
+    }
+
+    bool use_camera = left->get_num_frames() < 0 || right->get_num_frames() < 0;
+    int max_pairs = use_camera ? options.max_camera_frames : std::min(left->get_num_frames(), right->get_num_frames());
+
+    Chessboard detector(CORNERS_X, CORNERS_Y, SQUARE_SIZE);
+    FrameProcessor processor(detector, use_camera, options.verbose);
+    StereoCalibrator stereo;
+    auto obj_pts = detector.generate_object_points();
+
+    // One view of a pair, grabbed and processed on its own thread
+    struct StereoView {
+        bool ok = false;
+        cv::Mat frame;
+        FrameResult result;
+    };
+    auto grab = [&processor](FrameLoader& loader) {
+        StereoView view;
+        view.ok = loader.next_frame(view.frame);
+        if (view.ok) {
+            view.result = processor.process(view.frame);
+        }
+        return view;
+    };
+
+    // Draw the detection or the rejection reason onto a view
+    auto annotate = [](StereoView& view) {
+        if (view.result.accepted()) {
+            cv::drawChessboardCorners(view.frame, cv::Size(CORNERS_X, CORNERS_Y), view.result.corners, true);
+        }
+        else {
+            Renderer::draw_text(view.frame, FrameProcessor::status_message(view.result.status), {30,30},
+                                0.8, FrameProcessor::status_color(view.result.status));
+        }
+    };
+
+    // Place two views side by side, the right view is scaled to the height of the left
+    auto side_by_side = [](const cv::Mat& l, const cv::Mat& r) {
+        cv::Mat r_scaled = r;
+        if (r.rows != l.rows) {
+            cv::resize(r, r_scaled, cv::Size(r.cols * l.rows / r.rows, l.rows));
+        }
+        cv::Mat pair;
+        cv::hconcat(l, r_scaled, pair);
+        return pair;
+    };
+
+    DisplayThread display(WINDOW_NAME, cv::Size(PREVIEW_WIDTH, PREVIEW_HEIGHT));
+
+    cv::Mat last_left, last_right, shown;
+    int frame_count = 0;
+    auto next_sample_time = std::chrono::steady_clock::now();
+    while (frame_count < max_pairs) {
+        // Grab and detect both views concurrently
+        auto right_job = std::async(std::launch::async, [&] { return grab(*right); });
+        StereoView left_view = grab(*left);
+        StereoView right_view = right_job.get();
+        if (!left_view.ok || !right_view.ok) {
+            break;
+        }
+
+        // Keep the pair only if both views are accepted, camera pairs at most once per sample interval
+        bool accepted = left_view.result.accepted() && right_view.result.accepted() &&
+                        (!use_camera || std::chrono::steady_clock::now() >= next_sample_time);
+        bool counted = !use_camera || accepted;
+        if (accepted) {
+            next_sample_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAMPLE_INTERVAL_MS);
+            stereo.add_pair(left_view.result.corners, right_view.result.corners, obj_pts);
+            last_left = left_view.frame.clone();
+            last_right = right_view.frame.clone();
+        }
+
+        annotate(left_view);
+        annotate(right_view);
+        // Counted pairs stay on screen for the hold while the next ones are already processed
+        shown = side_by_side(left_view.frame, right_view.frame);
+        display.post(shown, counted ? options.hold_ms : 0);
+
+        int key = display.poll_key();
+        if (key == KEY_ESCAPE) {
+            std::cout << "Exiting..." << '\n';
+            break;
+        }
+
+        // Count every still pair, or accepted pairs in camera mode
+        if (counted) {
+            ++frame_count;
+        }
+    }
+
+    std::cout << "Collected " << stereo.get_num_pairs() << " stereo pairs." << '\n';
+    if (!stereo.calibrate(left->get_frame_size(), right->get_frame_size())) {
+        std::cerr << "Stereo calibration failed, no valid pairs." << '\n';
+        return -1;
+    }
+
+    std::string calibration_filename = Utils::filename_timestamp("stereo_calibration", "yml");
+    stereo.save(calibration_filename);
+    std::cout << "Stereo reprojection error: " << stereo.get_reproj_error() << '\n';
+    std::cout << "Stereo calibration saved as " << calibration_filename << std::endl;
+
+    // Show the last accepted pair rectified, with horizontal lines to check the epipolar alignment
+    if (!last_left.empty()) {
+        cv::Mat left_rect, right_rect;
+        stereo.rectify(last_left, last_right, left_rect, right_rect);
+        cv::Mat out_frame = side_by_side(left_rect, right_rect);
+        for (int y = 0; y < out_frame.rows; y += 40) {
+            cv::line(out_frame, {0, y}, {out_frame.cols - 1, y}, cv::Scalar(0,255,0), 1);
+        }
+
+        std::string filename = Utils::filename_timestamp("stereo_rectified", "png");
+        cv::imwrite(filename, out_frame);
+        std::cout << "Rectified pair saved as " << filename << std::endl;
+
+        display.post(out_frame);
+        while (true) {
+            int key = display.wait_key(0);
+            if (key == KEY_ESCAPE || key == 'q') {
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Calibrate a multi-camera rig, detecting on all camera streams in parallel
+ *
+ * Frames with the same index in every source are taken as synchronized. Every accepted view is a
+ * sample for the intrinsics of its camera; a frame counts as a rig sample when at least two cameras
+ * see the board, since only those constrain the extrinsics
+ * @param options Session options, rig_sources holds one source per camera
+ * @return Process exit code
+ */
+static int run_rig(const Options& options) {
+    size_t num_cameras = options.rig_sources.size();
+    std::vector<std::unique_ptr<FrameLoader>> loaders;
+    bool use_camera = false;
+    int max_steps = options.max_camera_frames;
+    int min_frames = -1;
+
+    for (const auto& source : options.rig_sources) {
+        loaders.push_back(FrameLoader::create(source));
+        if (!loaders.back() || !loaders.back()->is_opened()) {
+            std::cerr << "Could not open rig source " << source << '\n';
+            return -1;
+        }
+        int num_frames = loaders.back()->get_num_frames();
+        if (num_frames < 0) {
+            use_camera = true;
+        }
+        else {
+            min_frames = (min_frames < 0) ? num_frames : std::min(min_frames, num_frames);
+        }
+    }
+    if (!use_camera) {
+        max_steps = min_frames;
+    }
+
+    Chessboard detector(CORNERS_X, CORNERS_Y, SQUARE_SIZE);
+    FrameProcessor processor(detector, use_camera, options.verbose);
+    RigCalibrator rig(num_cameras, detector.generate_object_points());
+
+    // Tile all views into one preview as wide as the window
+    int grid_cols = (int)std::ceil(std::sqrt((double)num_cameras));
+    int grid_rows = (int)((num_cameras + grid_cols - 1) / grid_cols);
+    int tile_w = PREVIEW_WIDTH / grid_cols;
+    auto mosaic = [&](const std::vector<cv::Mat>& views) {
+        int tile_h = views[0].empty() ? tile_w * 3 / 4 : tile_w * views[0].rows / views[0].cols;
+        cv::Mat canvas = cv::Mat::zeros(tile_h * grid_rows, tile_w * grid_cols, CV_8UC3);
+        for (size_t c = 0; c < views.size(); ++c) {
+            if (views[c].empty()) {
+                continue;
+            }
+            cv::Rect tile((int)(c % grid_cols) * tile_w, (int)(c / grid_cols) * tile_h, tile_w, tile_h);
+            cv::resize(views[c], canvas(tile), tile.size(), 0, 0, cv::INTER_AREA);
+        }
+        return canvas;
+    };
+
+    DisplayThread display(WINDOW_NAME, cv::Size(PREVIEW_WIDTH, PREVIEW_HEIGHT));
+
+    std::vector<cv::Mat> frames(num_cameras);
+    cv::Mat shown;
+    std::vector<FrameResult> results(num_cameras);
+    std::vector<int> grabbed(num_cameras, 0);
+    int frame_index = 0;
+    int step_count = 0;
+    auto next_sample_time = std::chrono::steady_clock::now();
+
+    while (step_count < max_steps) {
+        // Grab and detect on every camera stream in parallel
+        cv::parallel_for_(cv::Range(0, (int)num_cameras), [&](const cv::Range& range) {
+            for (int c = range.start; c < range.end; ++c) {
+                grabbed[c] = loaders[c]->next_frame(frames[c]) ? 1 : 0;
+                results[c] = grabbed[c] ? processor.process(frames[c]) : FrameResult();
+            }
+        });
+        if (std::find(grabbed.begin(), grabbed.end(), 0) != grabbed.end()) {
+            break;
+        }
+
+        int num_accepted = 0;
+        for (size_t c = 0; c < num_cameras; ++c) {
+            num_accepted += results[c].accepted() ? 1 : 0;
+        }
+
+        // Keep every accepted view, camera frames at most once per sample interval; only frames that
+        // link at least two cameras count towards the camera frame limit
+        bool accepted = num_accepted >= 1 && (!use_camera || std::chrono::steady_clock::now() >= next_sample_time);
+        bool counted = !use_camera || (accepted && num_accepted >= 2);
+        if (accepted) {
+            next_sample_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAMPLE_INTERVAL_MS);
+        }
+        for (size_t c = 0; c < num_cameras; ++c) {
+            if (accepted && results[c].accepted()) {
+                rig.add_observation(frame_index, c, results[c].corners);
+            }
+
+            if (results[c].accepted()) {
+                cv::drawChessboardCorners(frames[c], cv::Size(CORNERS_X, CORNERS_Y), results[c].corners, true);
+            }
+            else {
+                Renderer::draw_text(frames[c], FrameProcessor::status_message(results[c].status), {30,30},
+                                    0.8, FrameProcessor::status_color(results[c].status));
+            }
+        }
+        ++frame_index;
+
+        // Counted frames stay on screen for the hold while the next ones are already processed
+        shown = mosaic(frames);
+        display.post(shown, counted ? options.hold_ms : 0);
+        int key = display.poll_key();
+        if (key == KEY_ESCAPE) {
+            std::cout << "Exiting..." << '\n';
+            break;
+        }
+
+        // Count every still frame, or linking frames in camera mode
+        if (counted) {
+            ++step_count;
+        }
+    }
+
+    std::vector<cv::Size> image_sizes;
+    for (size_t c = 0; c < num_cameras; ++c) {
+        image_sizes.push_back(loaders[c]->get_frame_size());
+        std::cout << "Camera " << c << ": " << rig.get_num_observations(c) << " observations." << '\n';
+    }
+
+    if (!rig.calibrate(image_sizes)) {
+        std::cerr << "Rig calibration failed, every camera needs views shared with the rest of the rig." << '\n';
+        return -1;
+    }
+
+    std::string rig_filename = Utils::filename_timestamp("rig_calibration", "yml");
+    rig.save(rig_filename);
+    std::cout << "Rig reprojection error: " << rig.get_reproj_error() << '\n';
+    std::cout << "Rig calibration saved as " << rig_filename << std::endl;
+    return 0;
+}
+
+
+/**
+ * @brief Calibrate every dataset of a list on one shared worker pool
+ * @param options Session options, batch_list, batch_dir, and convergence are used
+ * @return Process exit code
+ */
+static int run_batch(const Options& options) {
+    std::vector<std::string> directories = BatchCalibrator::read_list(options.batch_list);
+    if (directories.empty()) {
+        std::cerr << "No datasets listed in " << options.batch_list << '\n';
+        return -1;
+    }
+
+    Chessboard detector(CORNERS_X, CORNERS_Y, SQUARE_SIZE);
+    BatchCalibrator batch(detector, options.batch_dir, options.convergence);
+    for (const auto& directory : directories) {
+        if (!batch.add_dataset(directory)) {
+            std::cerr << "No frames found in " << directory << '\n';
+        }
+    }
+
+    ThreadBudget budget(options.threads);
+    auto start_time = std::chrono::steady_clock::now();
+    size_t calibrated = batch.run(budget);
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    for (const auto& report : batch.get_reports()) {
+        std::cout << report.directory << ": " << report.accepted << "/" << report.frames << " frames";
+        if (report.calibrated) {
+            std::cout << ", error " << report.reproj_error << (report.converged ? ", converged" : "")
+                      << ", saved as " << report.calibration_file;
+        }
+        else {
+            std::cout << ", calibration failed";
+        }
+        std::cout << '\n';
+    }
+
+    std::string report_filename = (std::filesystem::path(options.batch_dir) / Utils::filename_timestamp("batch_report", "yml")).string();
+    batch.save_report(report_filename);
+    std::cout << "Calibrated " << calibrated << " of " << directories.size() << " datasets in " << elapsed_s
+              << " s, report saved as " << report_filename << std::endl;
+    return calibrated == directories.size() ? 0 : -1;
+}
+
+
+/**
+ * @brief Open the pose stream requested on the command line
+ * @param options Session options, publish_file, publish_socket, and publish_binary are used
+ * @return Publisher, null if no pose stream is requested or none of its outputs could be opened
+ */
+static std::unique_ptr<PosePublisher> open_publisher(const Options& options) {
+    if (options.publish_file.empty() && options.publish_socket.empty()) {
+        return nullptr;
+    }
+    auto publisher = std::make_unique<PosePublisher>(options.publish_file, options.publish_socket, options.publish_binary);
+    if (!publisher->is_opened()) {
+        std::cerr << "No pose stream output could be opened, poses are not published." << '\n';
+        return nullptr;
+    }
+    return publisher;
+}
+
+/**
+ * @brief Queue the pose of an accepted frame on the pose stream
+ * @param publisher Pose stream
+ * @param frame_id Index of the frame in the session
+ * @param timestamp_us Frame arrival, microseconds since the Unix epoch
+ * @param result Accepted detection result
+ * @param uncalibrated True if the pose was solved with default intrinsics, as during calibration
+ */
+static void publish_pose(PosePublisher& publisher, int64_t frame_id, int64_t timestamp_us, const FrameResult& result,
+                         bool uncalibrated) {
+    PoseMessage message;
+    message.frame_id = frame_id;
+    message.timestamp_us = timestamp_us;
+    message.a1_index = result.a1_index;
+    message.reproj_error = result.reproj_error;
+    for (int i = 0; i < 3; ++i) {
+        message.rvec[i] = result.rvec.at<double>(i);
+        message.tvec[i] = result.tvec.at<double>(i);
+    }
+    message.uncalibrated = uncalibrated;
+    publisher.publish(message);
+}
+
+/**
+ * @brief Flush a pose stream and print its message counters
+ * @param publisher Pose stream
+ */
+static void report_publisher(PosePublisher& publisher) {
+    publisher.close();
+    std::cout << "Published " << publisher.get_published() << " poses, dropped " << publisher.get_dropped()
+              << ", missed by slow clients " << publisher.get_client_dropped() << std::endl;
+}
+
+/**
+ * @brief Start the annotated video recording requested on the command line
+ * @param options Session options
+ * @return Recorder, or nullptr if no recording is requested
+ */
+static std::unique_ptr<VideoRecorder> open_recorder(const Options& options) {
+    if (options.record_file.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<VideoRecorder>(options.record_file, options.record_codec, options.record_fps);
+}
+
+/**
+ * @brief Encode the remaining frames of a recording and print its counters
+ * @param recorder Video recorder
+ */
+static void report_recorder(VideoRecorder& recorder) {
+    recorder.close();
+    std::cout << "Recorded " << recorder.get_written() << " frames to " << recorder.get_path()
+              << ", dropped " << recorder.get_dropped() << std::endl;
+}
+
+/**
+ * @brief Set up the thread pinning and capture priority requested on the command line
+ * @param options Session options
+ * @return Placement, its plan printed if anything is configured
+ */
+static std::unique_ptr<ThreadPlacement> open_placement(const Options& options) {
+    auto placement = std::make_unique<ThreadPlacement>();
+    for (const auto& pin : options.pins) {
+        if (!placement->add_pin(pin)) {
+            std::cerr << "Invalid --pin " << pin << ", expected ROLE=CPUS with ROLE capture, detect, render, or display, ignored." << '\n';
+        }
+    }
+    placement->set_capture_priority(options.capture_priority);
+    if (placement->is_configured()) {
+        placement->print_plan();
+    }
+    return placement;
+}
+
+
+/**
+ * @brief Frame travelling through the tracking pipeline
+ */
+struct TrackedFrame {
+    cv::Mat frame;                                      // Captured frame
+    std::chrono::steady_clock::time_point arrival;      // Capture time
+    std::chrono::steady_clock::time_point pose_time;    // Time the pose was known
+    int64_t timestamp_us = 0;                           // Capture time, microseconds since the Unix epoch
+    FrameResult result;
+    cv::Mat shown;                                      // Annotated preview
 };
 
+/**
+ * @brief Still frame travelling through the parallel processing of an image sequence
+ */
+struct StillFrame {
+    size_t index = 0;                                   // Position in the sequence
+    bool loaded = false;                                // The file was decoded
+    cv::Mat frame;                                      // Decoded frame
+    int64_t timestamp_us = 0;                           // Processing time, microseconds since the Unix epoch
+    FrameResult result;
+    cv::Mat preview;                                    // Frame downsampled to the window size
+};
 
-int main(int argc, char** argv) {
-    // Verbose debug option
-    bool verbose_debug = false;
-    for (int i = 1; i < argc; ++i) {
-        if (std::string(argv[i]) == "--verbose" || std::string(argv[i]) == "-v") {
-            verbose_debug = true;
+/**
+ * @brief Track the board pose with a saved calibration, without collecting samples
+ *
+ * Run only detection, pose, and overlays on every frame at the highest achievable rate,
+ * and report the frame rate and the pose latency, from frame arrival to pose. Capture,
+ * detection, and rendering are pipeline stages on their own threads, detection on several,
+ * and frames reach publishing and display in capture order
+ * @param options Session options, track_file holds the saved calibration
+ * @param loader Frame source
+ * @param use_camera If true, the source is a live camera
+ * @param placement Placement of the capture, detection, render, and display threads
+ * @return Process exit code
+ */
+static int run_tracking(const Options& options, FrameLoader& loader, bool use_camera, ThreadPlacement& placement) {
+    using Clock = std::chrono::steady_clock;
+
+    Calibrator calibration;
+    if (!calibration.load(options.track_file)) {
+        std::cerr << "Could not load calibration " << options.track_file << '\n';
+        return -1;
+    }
+    const cv::Mat& K = calibration.get_camera_matrix();
+    const cv::Mat& dist = calibration.get_dist_coeffs();
+
+    Chessboard detector(CORNERS_X, CORNERS_Y, SQUARE_SIZE);
+    FrameProcessor processor(detector, use_camera, options.verbose);
+    processor.set_intrinsics(K, dist);
+
+    // Undistorted preview, drawn with the distortion-free camera matrix
+    Undistorter undistorter;
+    if (options.undistort) {
+        undistorter = Undistorter(K, dist, loader.get_frame_size());
+    }
+    OverlayScene scene = OverlayScene::chessboard(CORNERS_Y, CORNERS_X, SQUARE_SIZE);
+
+    // Overlays are drawn on the preview, with the camera matrix mapped to preview pixels
+    PreviewScaler scaler(cv::Size(PREVIEW_WIDTH, PREVIEW_HEIGHT));
+    Projection::Projector preview_projector;
+
+    // Optional marker on every square, alternating colors, drawn as one instanced batch with one polyline call per color
+    InstancedMesh markers(Mesh::marker(0.5f * SQUARE_SIZE));
+    if (options.markers) {
+        for (int row = 0; row <= CORNERS_Y; ++row) {
+            for (int col = 0; col <= CORNERS_X; ++col) {
+                Placement placement;
+                placement.position = cv::Point3f((col - 0.5f) * SQUARE_SIZE, (row - 0.5f) * SQUARE_SIZE, 0.0f);
+                placement.color = (row + col) % 2 == 0 ? cv::Scalar(0,200,255) : cv::Scalar(255,128,0);
+                markers.add(placement);
+            }
         }
     }
 
+    // Optional live pose stream for downstream consumers
+    std::unique_ptr<PosePublisher> publisher = open_publisher(options);
+
+    // Optional annotated recording, encoded in the background
+    std::unique_ptr<VideoRecorder> recorder = open_recorder(options);
+
+    // The window is owned by the display thread, processing never waits on repaints
+    DisplayThread display(WINDOW_NAME, cv::Size(PREVIEW_WIDTH, PREVIEW_HEIGHT), [&placement]() { placement.enter("display"); });
+
+    // Smoothed frame interval and pose latency, in milliseconds
+    double frame_ms = 0.0, latency_ms = 0.0, latency_sum_ms = 0.0;
+    int frames = 0, tracked = 0;
+    auto smooth = [](double avg, double value) { return avg == 0.0 ? value : 0.9 * avg + 0.1 * value; };
+
+    // Capture -> detect and pose, on several workers -> undistort, downsample, and draw -> in-order sink
+    Pipeline<TrackedFrame> pipeline;
+    pipeline.set_thread_init([&placement](const std::string& stage) { placement.enter(stage == "source" ? "capture" : stage); });
+
+    // Detection workers and OpenCV's threads share the budget left by the other stages
+    ThreadBudget budget(options.threads, TRACKING_RESERVED_THREADS);
+    unsigned detect_workers = budget.rebalance(MAX_DETECT_WORKERS).frame_workers;
+    ThreadPlacement::start_library_threads();
+    pipeline.add_stage("detect", [&](TrackedFrame& item) {
+        item.result = processor.process(item.frame);
+        item.pose_time = Clock::now();
+        return true;
+    }, detect_workers);
+
+    cv::Mat undistorted;
+    pipeline.add_stage("render", [&](TrackedFrame& item) {
+        const cv::Mat* source = &item.frame;
+        if (undistorter.is_ready()) {
+            undistorter.apply(item.frame, undistorted);
+            source = &undistorted;
+        }
+        if (scaler.plan(source->size())) {
+            preview_projector = undistorter.is_ready()
+                ? Projection::Projector(scaler.scale_camera_matrix(undistorter.get_camera_matrix()), cv::Mat())
+                : Projection::Projector(scaler.scale_camera_matrix(K), dist);
+        }
+        scaler.apply(*source, item.shown);
+
+        const FrameResult& result = item.result;
+        if (result.accepted()) {
+            markers.render(item.shown, preview_projector, result.rvec, result.tvec);
+            scene.render(item.shown, preview_projector, result.rvec, result.tvec);
+        }
+        else {
+            Renderer::draw_text(item.shown, FrameProcessor::status_message(result.status), {30,30},
+                                0.8, FrameProcessor::status_color(result.status));
+        }
+        return true;
+    });
+
+    auto last_frame_time = Clock::now();
+    auto start_time = last_frame_time;
+    auto capture = [&](TrackedFrame& item) {
+        if (!loader.next_frame(item.frame)) {
+            return false;
+        }
+        item.arrival = Clock::now();
+        item.timestamp_us = PosePublisher::now_us();
+        return true;
+    };
+    auto present = [&](uint64_t seq, TrackedFrame& item, bool) {
+        const FrameResult& result = item.result;
+        if (publisher && result.accepted()) {
+            publish_pose(*publisher, (int64_t)seq, item.timestamp_us, result, false);
+        }
+
+        double latency = std::chrono::duration<double, std::milli>(item.pose_time - item.arrival).count();
+        double interval = std::chrono::duration<double, std::milli>(item.arrival - last_frame_time).count();
+        last_frame_time = item.arrival;
+        latency_ms = smooth(latency_ms, latency);
+        frame_ms = frames > 0 ? smooth(frame_ms, interval) : 0.0;
+        latency_sum_ms += latency;
+        tracked += result.accepted() ? 1 : 0;
+        ++frames;
+
+        char stats[96];
+        std::snprintf(stats, sizeof(stats), "FPS: %.1f  Pose latency: %.1f ms", frame_ms > 0.0 ? 1000.0 / frame_ms : 0.0, latency_ms);
+        Renderer::draw_text(item.shown, stats, {30, 60}, 0.8, cv::Scalar(255,255,0));
+
+        if (recorder) {
+            recorder->record(item.shown);
+        }
+        display.post(item.shown);
+        int key = display.poll_key();
+        if (key == KEY_ESCAPE || key == 'q') {
+            pipeline.stop();
+        }
+    };
+    pipeline.run(capture, present);
+
+    double elapsed_s = std::chrono::duration<double>(Clock::now() - start_time).count();
+    if (frames > 0) {
+        std::cout << "Tracked " << tracked << " of " << frames << " frames, "
+                  << frames / std::max(elapsed_s, 1e-9) << " FPS, mean pose latency "
+                  << latency_sum_ms / frames << " ms, " << display.get_skipped() << " frames not displayed" << std::endl;
+    }
+    if (options.verbose) {
+        const ThreadAllocation& allocation = budget.get_allocation();
+        std::cout << "Thread budget " << allocation.budget << ": " << allocation.frame_workers << " detection workers, "
+                  << allocation.cv_threads << " OpenCV threads" << '\n';
+        for (const auto& stage : pipeline.get_stats()) {
+            std::cout << "Stage " << stage.name << " (" << stage.workers << " workers): " << stage.items << " frames, busy "
+                      << stage.busy_ms << " ms, starved " << stage.starved_ms << " ms, blocked " << stage.blocked_ms << " ms" << '\n';
+        }
+    }
+    if (options.verbose || placement.is_configured()) {
+        placement.report();
+    }
+    if (publisher) {
+        report_publisher(*publisher);
+    }
+    if (recorder) {
+        report_recorder(*recorder);
+    }
+    return 0;
+}
+
+
+int main(int argc, char** argv) {
+    // Command line options
+    Options options = Options::parse(argc, argv);
+    bool verbose_debug = options.verbose;
+
+    // Offline calibration from stored detections, no input source needed
+    if (!options.resolve_dir.empty()) {
+        return resolve_from_store(options);
+    }
+
+    // Stereo pair from two sources given on the command line
+    if (options.stereo_sources.size() == 2) {
+        return run_stereo(options);
+    }
+
+    // Multi-camera rig from a list of sources
+    if (options.rig_sources.size() >= 2) {
+        return run_rig(options);
+    }
+
+    // Batch of still-frame datasets, one calibration per dataset
+    if (!options.batch_list.empty()) {
+        return run_batch(options);
+    }
+
     // Enumerate available input sources (still frames and cameras)
     std::vector<int> available_devices;
     std::vector<std::string> device_names;
@@ -86,7 +784,7 @@ int main(int argc, char** argv) {
 
     // Still frames
     if (available_devices[device_choice] == -1) {
-        std::string frames_dir = argc > 1 ? argv[1] : "res/frames";
+        const std::string& frames_dir = options.frames_dir;
         loader = std::make_unique<ImageSequenceLoader>(frames_dir);
         if (!loader->is_opened()) {
             std::cerr << "No images found in " << frames_dir << '\n';
@@ -104,317 +802,408 @@ int main(int argc, char** argv) {
         }
     }
 
+    // Optional pinning of the session threads and real-time priority for capture, OpenCV's workers are
+    // started first so they do not inherit the placement of the thread that happens to start them
+    std::unique_ptr<ThreadPlacement> placement = open_placement(options);
+    ThreadPlacement::start_library_threads();
+
+    // Tracking only with a saved calibration, no sample collection
+    if (!options.track_file.empty()) {
+        return run_tracking(options, *loader, use_camera, *placement);
+    }
+
+    // Calibration captures, detects, calibrates, and draws on the main thread, which stays unplaced,
+    // a real-time or pinned capture role would hold all of that work
+    if (placement->places("capture") || placement->places("detect") || placement->places("render")) {
+        std::cerr << "Capture, detection, and render placement (--pin, --capture-fifo) apply to tracking (--track) only, "
+                  << "calibration runs them on the unplaced main thread." << '\n';
+    }
+
     // Calibration and chessboard setup
     Chessboard detector(CORNERS_X, CORNERS_Y, SQUARE_SIZE);
     Calibrator calibrator;
-    std::vector<FrameCorners> all_frame_corners;
+    FrameArchive archive;
     cv::Mat last_valid_frame;
-    int last_valid_corners_idx = -1;
     int frame_count = 0;
+    int max_frames = use_camera ? options.max_camera_frames : loader->get_num_frames();
+    int frames_read = 0;
+    bool converged = false;
+
+    // Optional corner store that receives every accepted detection
+    std::unique_ptr<CornerStoreWriter> store;
+    if (!options.store_dir.empty()) {
+        store = std::make_unique<CornerStoreWriter>(options.store_dir, CORNERS_X * CORNERS_Y, loader->get_frame_size());
+        if (!store->is_opened()) {
+            std::cerr << "Could not open corner store " << options.store_dir
+                      << ", or it holds another board or frame size, detections are not stored." << '\n';
+            store.reset();
+        }
+    }
 
-    cv::namedWindow(WINDOW_NAME, cv::WINDOW_AUTOSIZE);
+    // Optional live pose stream for downstream consumers
+    std::unique_ptr<PosePublisher> publisher = open_publisher(options);
 
-    // Center the OpenCV window on the screen
-    Utils::center_opencv_window(WINDOW_NAME, 1280, 720);
+    // Optional annotated recording, encoded in the background
+    std::unique_ptr<VideoRecorder> recorder = open_recorder(options);
 
-    // Show a blank frame to ensure the window is created and can be focused
-    cv::Mat blank_frame = cv::Mat::zeros(720, 1280, CV_8UC3);
-    cv::imshow(WINDOW_NAME, blank_frame);
-    Utils::focus_opencv_window(WINDOW_NAME);
+    // Saved images are encoded on a small pool, optionally every accepted frame with its overlay
+    ImageWriter image_writer(options.save_format, options.save_level);
+    if (!options.save_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(options.save_dir, ec);
+    }
 
-    // Lambda for drawing overlays (axes, labels, etc.)
-    auto draw_overlays = [](cv::Mat& img, const cv::Mat& K, const cv::Mat& dist, const cv::Mat& rvec, const cv::Mat& tvec, float square_size) {
-        cv::Point3f outer_corner_offset(-square_size, -square_size, 0);
-        Renderer::draw_axes(img, K, dist, rvec, tvec, outer_corner_offset);
-        Renderer::draw_labels(img, CORNERS_Y, CORNERS_X, square_size, K, dist, rvec, tvec, outer_corner_offset);
-    };
+    // The window is created, centered, and repainted by the display thread, processing never waits on it
+    DisplayThread display(WINDOW_NAME, cv::Size(PREVIEW_WIDTH, PREVIEW_HEIGHT), [&placement]() { placement->enter("display"); });
 
-    // Lambda for creating a default camera matrix
-    auto make_camera_matrix = [](int width, int height) {
-        cv::Mat K = cv::Mat::eye(3, 3, CV_64F);
-        K.at<double>(0, 0) = 1000.0;
-        K.at<double>(1, 1) = 1000.0;
-        K.at<double>(0, 2) = width / 2.0;
-        K.at<double>(1, 2) = height / 2.0;
-        return K;
-    };
+    // Overlay of accepted frames (axes and labels), built once and projected in one batch per frame
+    OverlayScene preview_scene;
+    cv::Point3f outer_corner_offset(-SQUARE_SIZE, -SQUARE_SIZE, 0);
+    preview_scene.add_axes(outer_corner_offset);
+    preview_scene.add_labels(CORNERS_Y, CORNERS_X, SQUARE_SIZE, outer_corner_offset);
 
-    // Lambda for drawing error overlays
-    auto draw_error = [](cv::Mat& frame, const std::string& msg, cv::Point pos, cv::Scalar color) {
-        cv::putText(frame, msg, pos, cv::FONT_HERSHEY_SIMPLEX, 0.8, color, 2);
+    // Lambda for drawing error overlays, returns the region drawn
+    auto draw_error = [](cv::Mat& canvas, const std::string& msg, cv::Point pos, cv::Scalar color) {
+        return Renderer::draw_text(canvas, msg, pos, 0.8, cv::Scalar(color[0], color[1], color[2], 255));
     };
 
-    // Lambda for finding the best pose (PnP) and corner order
-    auto find_best_pose = [&](const std::vector<cv::Point2f>& corners, const cv::Mat& frame, const cv::Mat& gray, 
-                              std::vector<double>& outer_vals, std::vector<cv::Point2f>& best_corners, 
-                              cv::Mat& best_rvec, cv::Mat& best_tvec, int& best_a1, double& best_reproj_err)
-    {
-        std::vector<int> a1_candidates = {0, 1, 2, 3};
-
-        int rows = CORNERS_Y;
-        int cols = CORNERS_X;
-
-        cv::Point2f tl = corners[0];
-        cv::Point2f tr = corners[cols - 1];
-        cv::Point2f bl = corners[(rows - 1) * cols];
-        cv::Point2f br = corners[rows * cols - 1];
-        cv::Point2f dx = (tr - tl) / (cols - 1);
-        cv::Point2f dy = (bl - tl) / (rows - 1);
-
-        std::vector<cv::Point2f> outer_corners = {
-            tl - dx / 2 - dy / 2,
-            tr + dx / 2 - dy / 2,
-            bl - dx / 2 + dy / 2,
-            br + dx / 2 + dy / 2
-        };
-        
-        outer_vals.assign(4, 1e6);
-        for (int i = 0; i < 4; ++i) {
-            auto pt = outer_corners[i];
-            if (pt.x < 2 || pt.y < 2 || pt.x > gray.cols - 3 || pt.y > gray.rows - 3) {
-                continue;
+    // Frame processing
+    FrameProcessor processor(detector, use_camera, verbose_debug);
+    PreviewScaler scaler(cv::Size(PREVIEW_WIDTH, PREVIEW_HEIGHT));
+    Projection::Projector frame_projector, preview_projector;
+    std::vector<cv::Point2f> preview_corners;
+
+    // Frames are read into two alternating buffers, so the last accepted frame is kept without a copy
+    // while the next one is captured, and overlays live on a separate layer that never touches them.
+    // The overlay is drawn at preview resolution, full-resolution overlays are drawn only for saved outputs
+    cv::Mat frame_buffers[2];
+    int current_buffer = 0;
+    OverlayLayer overlay;
+    cv::Mat shown;
+    auto next_sample_time = std::chrono::steady_clock::now();
+
+    // Handle one processed frame in source order: sample it, check convergence, draw and show it.
+    // The calibration depends only on this order, so it is the same however the frames were processed.
+    // Returns false when the user ends the session
+    auto handle_frame = [&](const cv::Mat& frame, const FrameResult& result, const std::string& path,
+                            int64_t timestamp_us, cv::Mat& preview) {
+        int64_t frame_id = frames_read++;
+        bool detected = result.accepted();
+        bool show_error = !detected;
+
+        // Camera frames become samples at most once per sample interval, detection and overlays continue meanwhile
+        bool accepted = detected && (!use_camera || std::chrono::steady_clock::now() >= next_sample_time);
+        bool counted = !use_camera || accepted;
+        std::string error_msg = FrameProcessor::status_message(result.status);
+        cv::Scalar error_color = FrameProcessor::status_color(result.status);
+
+        if (accepted) {
+            next_sample_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAMPLE_INTERVAL_MS);
+
+            // Accept this frame for calibration
+            auto obj_pts = detector.generate_object_points();
+            calibrator.add_sample(result.corners, obj_pts);
+            last_valid_frame = frame; // Overlays are never drawn on the frame, keep its buffer
+
+            // Retain the accepted frame for the overlay export
+            if (!options.export_dir.empty()) {
+                archive.add(frame, path);
             }
-            cv::Rect roi(pt - cv::Point2f(2,2), cv::Size(5,5));
-            double val = cv::mean(gray(roi))[0];
-            outer_vals[i] = val;
-        }
 
-        best_reproj_err = 1e9;
-        best_a1 = -1;
-        best_corners.clear();
-        best_rvec.release();
-        best_tvec.release();
+            // Publish the pose to downstream consumers, marked as solved with the default intrinsics
+            if (publisher) {
+                publish_pose(*publisher, frame_id, timestamp_us, result, true);
+            }
 
-        double max_reproj_err = 8.0;
-        cv::Mat K = cv::Mat::eye(3, 3, CV_64F);
+            // Stream the detection to the corner store
+            if (store) {
+                CornerRecord record;
+                record.frame_id = frame_id;
+                record.a1_index = result.a1_index;
+                record.image_pts = result.corners;
+                record.rvec = cv::Vec3d(result.rvec);
+                record.tvec = cv::Vec3d(result.tvec);
+                record.reproj_error = (float)result.reproj_error;
+                record.sharpness = (float)result.sharpness;
+                store->append(record);
+            }
 
-        K.at<double>(0, 0) = 1000.0;
-        K.at<double>(1, 1) = 1000.0;
-        K.at<double>(0, 2) = frame.cols / 2.0;
-        K.at<double>(1, 2) = frame.rows / 2.0;
+            if (verbose_debug) {
+                std::cout << "Accepted for calibration. Reprojection error: " << result.reproj_error << " (max 8.0)" << '\n';
+            }
 
-        cv::Mat dist_coeffs = cv::Mat::zeros(5,1,CV_64F);
+            // Stop as soon as the intrinsics are known well enough
+            if ((int)calibrator.get_num_samples() >= options.convergence.min_samples && 
+                calibrator.calibrate(loader->get_frame_size())) {
+                converged = calibrator.has_converged(options.convergence);
+                if (verbose_debug) {
+                    const cv::Mat& std_dev = calibrator.get_std_intrinsics();
+                    std::cout << "Intrinsics std: fx=" << std_dev.at<double>(0) << ", fy=" << std_dev.at<double>(1)
+                              << ", cx=" << std_dev.at<double>(2) << ", cy=" << std_dev.at<double>(3)
+                              << (converged ? " (converged)" : "") << '\n';
+                }
+            }
+        }
 
-        for (int a1_index : a1_candidates) {
-            std::vector<cv::Point2f> test_corners = corners;
-            
-            detector.reorder_corners(test_corners, a1_index);
-            auto obj_pts = detector.generate_object_points();
+        // Redraw the overlay only when what it shows changed, e.g. not for consecutive frames without a board
+        int frames_left = (use_camera && frame_count < max_frames) ? max_frames - frame_count : -1;
+        uint64_t content_key = OverlayLayer::hash(&result.status, sizeof(result.status));
+        content_key = OverlayLayer::hash(&frames_left, sizeof(frames_left), content_key);
+        if (detected) {
+            content_key = OverlayLayer::hash(result.corners.data(), result.corners.size() * sizeof(cv::Point2f), content_key);
+            content_key = OverlayLayer::hash(result.rvec.ptr(), result.rvec.total() * result.rvec.elemSize(), content_key);
+            content_key = OverlayLayer::hash(result.tvec.ptr(), result.tvec.total() * result.tvec.elemSize(), content_key);
+        }
 
-            cv::Mat rvec, tvec;
-            bool pnp_ok = cv::solvePnP(obj_pts, test_corners, K, dist_coeffs, rvec, tvec, false, cv::SOLVEPNP_ITERATIVE);
-            
-            cv::Mat R;
-            cv::Rodrigues(rvec, R);
-            
-            bool z_ok = pnp_ok && (R.at<double>(2,2) > 0);
-            double reproj_err = 1e9;
-            
-            if (z_ok) {
-                std::vector<cv::Point2f> proj_pts;
-                cv::projectPoints(obj_pts, rvec, tvec, K, dist_coeffs, proj_pts);
-                double err = 0.0;
-
-                for (size_t i = 0; i < proj_pts.size(); ++i) {
-                    err += cv::norm(proj_pts[i] - test_corners[i]);
-                }
+        // The pinhole kernel for the default camera matrix, mapped to the preview, is selected once per frame size
+        if (scaler.plan(frame.size())) {
+            cv::Mat K = FrameProcessor::default_camera_matrix(frame.cols, frame.rows);
+            frame_projector = Projection::Projector(K, cv::Mat());
+            preview_projector = Projection::Projector(scaler.scale_camera_matrix(K), cv::Mat());
+        }
 
-                reproj_err = err / proj_pts.size();
-                if (reproj_err > 15.0) {
-                    z_ok = false;
-                }
+        // Save the accepted frame with a full-resolution overlay, encoded in the background
+        if (accepted && !options.save_dir.empty()) {
+            cv::Mat annotated = frame.clone();
+            Renderer::draw_corners(annotated, cv::Size(CORNERS_X, CORNERS_Y), result.corners);
+            preview_scene.render(annotated, frame_projector, result.rvec, result.tvec);
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%05lld.", (long long)frame_id);
+            image_writer.write((std::filesystem::path(options.save_dir) / (name + image_writer.get_format())).string(), annotated);
+        }
+        if (overlay.update(scaler.get_size(), content_key)) {
+            cv::Mat& canvas = overlay.canvas();
+            if (detected) {
+                // Draw chessboard grid
+                scaler.scale_points(result.corners, preview_corners);
+                overlay.mark_dirty(Renderer::draw_corners(canvas, cv::Size(CORNERS_X, CORNERS_Y), preview_corners));
+
+                // Draw axes and labels
+                overlay.mark_dirty(preview_scene.render(canvas, preview_projector, result.rvec, result.tvec));
             }
 
-            if (verbose_debug) {
-                std::cout << "A1 candidate " << a1_index
-                          << ": pixel value=" << outer_vals[a1_index]
-                          << ", solvePnP=" << (pnp_ok ? "true" : "false")
-                          << ", z_outwards=" << (z_ok ? "true" : "false")
-                          << ", reprojErr=" << reproj_err << (z_ok ? " (OK)" : " (FAIL)") << '\n';
+            // Show how many frames are left at most (overlay on preview) only in camera mode
+            if (frames_left >= 0) {
+                std::string frame_msg = "Frames left: " + std::to_string(frames_left);
+                overlay.mark_dirty(Renderer::draw_text(canvas, frame_msg, {30, 60}, 0.8, cv::Scalar(255,255,0,255)));
             }
 
-            if (z_ok && reproj_err < best_reproj_err) {
-                best_reproj_err = reproj_err;
-                best_a1 = a1_index;
-                best_corners = test_corners;
-                best_rvec = rvec.clone();
-                best_tvec = tvec.clone();
+            // Draw error if needed
+            if (show_error) {
+                overlay.mark_dirty(draw_error(canvas, error_msg, {30,30}, error_color));
             }
         }
-    };
 
-    // Frame processing
-    cv::Mat frame;
-    while (frame_count < (use_camera ? REQUIRED_FRAMES : loader->get_num_frames()) && loader->next_frame(frame)) {
-        // Store a clean copy of the frame before any overlays
-        cv::Mat clean_frame = frame.clone();
-        bool accepted = false;
-        bool show_error = false;
-        std::string error_msg;
-        cv::Scalar error_color;
-
-        // Show how many frames are still required (overlay on preview) only in camera mode
-        if (use_camera && frame_count < REQUIRED_FRAMES) {
-            int frames_left = REQUIRED_FRAMES - frame_count;
-            std::string frame_msg = "Frames left: " + std::to_string(frames_left);
-            cv::putText(frame, frame_msg, {30, 60}, cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(255,255,0), 2);
-        }
-
-        // Convert to grayscale
-        cv::Mat gray;
-        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
-
-        // Early continue if blurred
-        if (Utils::is_blurred(gray, use_camera)) {
-            show_error = true;
-            error_msg = "Frame is blurred";
-            error_color = cv::Scalar(0,0,255);
+        // Always show the frame for smooth camera updates, downsampled once to the window size,
+        // unless a worker already did
+        if (preview.empty()) {
+            scaler.apply(frame, shown);
         }
         else {
-            // Find chessboard corners
-            std::vector<cv::Point2f> corners;
-            if (!detector.find_corners(frame, corners)) {
-                show_error = true;
-                error_msg = "Chessboard not found";
-                error_color = cv::Scalar(0,255,255);
-            }
-            else {
-                // Try all possible A1 corners and find the best pose
-                std::vector<double> outer_vals;
-                std::vector<cv::Point2f> best_corners;
-                cv::Mat best_rvec, best_tvec;
-                int best_a1 = -1;
-                double best_reproj_err = 1e9;
-
-                // Find the best pose and corner ordering
-                find_best_pose(corners, frame, gray, outer_vals, best_corners, best_rvec, best_tvec, best_a1, best_reproj_err);
-
-                // If no valid pose was found, draw an error message
-                if (best_a1 == -1) {
-                    show_error = true;
-                    error_msg = "Pose not valid";
-                    error_color = cv::Scalar(0,165,255);
-                }
-                else {
-                    // Accept this frame for calibration
-                    auto obj_pts = detector.generate_object_points();
-                    calibrator.add_sample(best_corners, obj_pts);
-                    last_valid_frame = clean_frame.clone(); // Use the clean frame without overlays
-                    accepted = true;
-
-                    // Store both A1 and H8 corner orderings for visualization
-                    std::vector<cv::Point2f> a1_corners = best_corners;
-                    std::vector<cv::Point2f> h8_corners = best_corners;
-                    detector.reorder_corners(h8_corners, 3 - best_a1);
-                    all_frame_corners.push_back({a1_corners, h8_corners});
-                    last_valid_corners_idx = (int)all_frame_corners.size() - 1;
-
-                    // Draw chessboard grid
-                    cv::drawChessboardCorners(frame, cv::Size(CORNERS_X, CORNERS_Y), best_corners, true);
-
-                    // Draw axes and labels
-                    cv::Mat K = make_camera_matrix(frame.cols, frame.rows);
-                    cv::Mat dist_coeffs = cv::Mat::zeros(5,1,CV_64F);
-                    draw_overlays(frame, K, dist_coeffs, best_rvec, best_tvec, SQUARE_SIZE);
-
-                    if (verbose_debug) {
-                        std::cout << "Accepted for calibration. Reprojection error: " << best_reproj_err << " (max 8.0)" << '\n';
-                    }
-                }
-            }
-        }
-
-        // Draw error if needed
-        if (show_error) {
-            draw_error(frame, error_msg, {30,30}, error_color);
+            std::swap(shown, preview);
         }
-
-        // Always show the frame for smooth camera updates
-        cv::imshow(WINDOW_NAME, frame);
-        if (use_camera && frame_count == 0) {
-            Utils::focus_opencv_window(WINDOW_NAME);
+        overlay.blend(shown);
+        if (recorder) {
+            recorder->record(shown);
         }
+        // Counted frames stay on screen for the hold so the user can observe the overlay, while
+        // capture and detection continue; frames posted meanwhile are not shown
+        display.post(shown, counted ? options.hold_ms : 0);
 
-        // Use a very short wait for smooth updates
-        int key = cv::waitKey(1);
+        // Keys pressed in the window are queued by the display thread
+        int key = display.poll_key();
         if (key == KEY_ESCAPE) {
             std::cout << "Exiting..." << '\n';
-            break;
+            return false;
         }
 
         // Only increment frame count for still frames, or for accepted frames in camera mode
-        if (!use_camera || (use_camera && accepted)) {
+        if (counted) {
             ++frame_count;
+        }
+        return true;
+    };
 
-            // Pause for 1 second to let the user observe the overlay
-            int pauseKey = cv::waitKey(1000);
-            if (pauseKey == KEY_ESCAPE) {
-                std::cout << "Exiting..." << '\n';
+    // Still frames are independent until they are sampled, so they are decoded and processed as tasks on
+    // a work-stealing pool, and handled in file order; the session stops at the same frame as a sequential run.
+    // Frames differ a lot in cost, a blurred one is rejected quickly while a failed chessboard search is slow,
+    // so idle workers steal frames and pose candidates instead of waiting behind a slow frame
+    // Our workers and OpenCV's threads share one budget, split once for the parallel phase, since OpenCV's
+    // thread count must not change while frames are in flight
+    ThreadBudget budget(options.threads);
+    auto* sequence = dynamic_cast<ImageSequenceLoader*>(loader.get());
+    unsigned jobs = options.jobs > 0 ? (unsigned)options.jobs : budget.get_available();
+    unsigned frame_workers = std::min(jobs, budget.get_available());
+    if (!use_camera && sequence && frame_workers > 1) {
+        budget.rebalance(frame_workers);
+        TaskScheduler& scheduler = budget.get_scheduler();
+        processor.set_scheduler(&scheduler);
+
+        // A sliding window of frames in flight, slot i % window holds frame i until it is handled. The window
+        // is the frame workers, so at most that many frames run at once, on the pool and the waiting caller
+        const size_t num_files = sequence->get_filenames().size();
+        const size_t window = frame_workers;
+        std::vector<StillFrame> slots(window);
+        std::vector<TaskGroup> groups(window);
+        std::atomic<bool> cancelled{false};
+        auto submit = [&](size_t index) {
+            StillFrame& slot = slots[index % window];
+            slot = StillFrame();
+            slot.index = index;
+            scheduler.spawn(groups[index % window], [&, index]() {
+                StillFrame& item = slots[index % window];
+                if (cancelled.load(std::memory_order_relaxed) || !sequence->load_frame(index, item.frame)) {
+                    return;
+                }
+                item.loaded = true;
+                item.timestamp_us = PosePublisher::now_us();
+                item.result = processor.process(item.frame);
+
+                // Downsample on the worker too, with the same plan the handler builds for this frame size
+                PreviewScaler item_scaler(cv::Size(PREVIEW_WIDTH, PREVIEW_HEIGHT));
+                item_scaler.plan(item.frame.size());
+                item_scaler.apply(item.frame, item.preview);
+            });
+        };
+
+        size_t submitted = 0;
+        while (submitted < std::min(window, num_files)) {
+            submit(submitted++);
+        }
+
+        // Frames processed ahead of the stop are discarded, a sequential run would not have read them.
+        // An unreadable file ends the session, as it ends a sequential run
+        bool done = max_frames <= 0;
+        for (size_t next = 0; next < num_files && !done; ++next) {
+            scheduler.wait(groups[next % window]);
+            StillFrame& item = slots[next % window];
+            done = !item.loaded
+                || !handle_frame(item.frame, item.result, sequence->get_filenames()[item.index], item.timestamp_us, item.preview)
+                || converged || frame_count >= max_frames;
+            if (!done && submitted < num_files) {
+                submit(submitted++);
+            }
+        }
+        cancelled = true;
+        for (auto& group : groups) {
+            scheduler.wait(group);
+        }
+        processor.set_scheduler(nullptr);
+
+        if (verbose_debug) {
+            auto stats = scheduler.get_stats();
+            for (size_t t = 0; t < stats.size(); ++t) {
+                std::cout << "Worker " << t << ": " << stats[t].executed << " tasks, " << stats[t].stolen << " stolen" << '\n';
+            }
+            const ThreadAllocation& allocation = budget.get_allocation();
+            std::cout << "Thread budget " << allocation.budget << ": " << allocation.frame_workers << " frame workers, "
+                      << allocation.cv_threads << " OpenCV threads" << '\n';
+        }
+
+        // Nothing is in flight, the final calibration gets the whole budget for OpenCV; the pool is released
+        budget.rebalance(1);
+    }
+    else {
+        cv::Mat preview;
+        while (!converged && frame_count < max_frames && loader->next_frame(frame_buffers[current_buffer])) {
+            cv::Mat frame = frame_buffers[current_buffer];
+
+            // Process the clean frame before any overlays are drawn on it
+            int64_t timestamp_us = PosePublisher::now_us();
+            FrameResult result = processor.process(frame);
+            bool running = handle_frame(frame, result, loader->get_frame_path(), timestamp_us, preview);
+
+            // An accepted frame is kept as the last valid frame, capture the next one into the other buffer
+            if (last_valid_frame.data == frame.data) {
+                current_buffer ^= 1;
+            }
+            if (!running) {
                 break;
             }
         }
     }
 
-    // Calibration and final overlay visualization
-    if (calibrator.calibrate(loader->get_frame_size())) {
+    if (store) {
+        store->flush();
+    }
+    if (publisher) {
+        report_publisher(*publisher);
+    }
+    if (recorder) {
+        report_recorder(*recorder);
+    }
+    if (use_camera && (verbose_debug || placement->is_configured())) {
+        placement->report();
+    }
+
+    if (converged) {
+        std::cout << "Calibration converged after " << calibrator.get_num_samples() << " samples." << '\n';
+    }
+
+    // Calibration and final overlay visualization, the converged calibration is already up to date
+    if (converged || calibrator.calibrate(loader->get_frame_size())) {
         // Save calibration results to file
         std::string calibration_filename = Utils::filename_timestamp("calibration", "yml");
         calibrator.save(calibration_filename);
         std::cout << "Calibration saved as " << calibration_filename << std::endl;
 
-        // If there are valid corners, draw the final visualization
-        if (last_valid_corners_idx != -1) {
-            // Generate the object points for the chessboard corners
-            cv::Mat rvec, tvec;
-            Chessboard detector(CORNERS_X, CORNERS_Y, SQUARE_SIZE);
-            auto obj_pts = detector.generate_object_points();
+        // Undistortion maps are built once and shared by the export and the final frame
+        Undistorter undistorter;
+        if (options.undistort) {
+            undistorter = Undistorter(calibrator.get_camera_matrix(), calibrator.get_dist_coeffs(), loader->get_frame_size());
+        }
 
-            // Use the last valid corners for visualization
-            FrameCorners vis_corners = all_frame_corners[last_valid_corners_idx];
+        // Render the calibrated overlay on all accepted frames
+        if (!options.export_dir.empty()) {
+            size_t exported = archive.export_overlays(options.export_dir, calibrator, detector, &undistorter);
+            std::cout << "Exported " << exported << " annotated frames to " << options.export_dir << std::endl;
+        }
 
-            // If the pose is valid, draw the axes and cubes
-            cv::Mat out_frame = last_valid_frame.clone();
-            if (cv::solvePnP(obj_pts, vis_corners.a1, calibrator.get_camera_matrix(), calibrator.get_dist_coeffs(), rvec, tvec)) {
-                // Draw axes and labels
-                draw_overlays(out_frame, calibrator.get_camera_matrix(), calibrator.get_dist_coeffs(), rvec, tvec, SQUARE_SIZE);
-
-                // Draw the white cube at E1
-                cv::Point3f e1_3d(-SQUARE_SIZE, 3 * SQUARE_SIZE, 0);
-                Renderer::draw_cube(out_frame, calibrator.get_camera_matrix(), calibrator.get_dist_coeffs(), rvec, tvec, e1_3d, cv::Scalar(255,255,255));
-
-                // Draw the black cube at E8
-                cv::Point3f e8_3d = e1_3d + cv::Point3f(7 * SQUARE_SIZE, 0, 0);
-                Renderer::draw_cube(out_frame, calibrator.get_camera_matrix(), calibrator.get_dist_coeffs(), rvec, tvec, e8_3d, cv::Scalar(0,0,0));
-
-                // Project the origin point (0,0,0) in 3D space to 2D
-                std::vector<cv::Point2f> origin2d;
-                std::vector<cv::Point3f> origin3d = {cv::Point3f(-SQUARE_SIZE, -SQUARE_SIZE, 0)};
-                cv::projectPoints(origin3d, rvec, tvec, calibrator.get_camera_matrix(), calibrator.get_dist_coeffs(), origin2d);
-
-                // Draw the origin point (0,0) in 3D space
-                cv::circle(out_frame, origin2d[0], 10, cv::Scalar(0,0,255), -1);
-
-                // Draw text
-                cv::putText(out_frame, "Chessboard base", {30,30}, cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255,255,255), 2);
-
-                // Save the final frame
-                std::string filename = Utils::filename_timestamp("final_frame", "png");
-                cv::imwrite(filename, out_frame);
-                std::cout << "Final frame saved as " << filename << std::endl;
-
-                // Show the final frame until user exits
-                cv::imshow(WINDOW_NAME, out_frame);
-                Utils::focus_opencv_window(WINDOW_NAME);
-                // Wait until user exits
-                while (true) {
-                    int key = cv::waitKey(0);
-                    if (key == KEY_ESCAPE || key == 'q') {
-                        break;
-                    }
+        // Draw the final visualization with the extrinsics of the last accepted frame
+        const auto& rvecs = calibrator.get_rvecs();
+        const auto& tvecs = calibrator.get_tvecs();
+        if (!last_valid_frame.empty() && !rvecs.empty()) {
+            // Draw axes, labels, cubes, and the board origin, undistorted frames have no distortion left
+            cv::Mat out_frame;
+            if (undistorter.is_ready()) {
+                undistorter.apply(last_valid_frame, out_frame);
+                Renderer::draw_board(out_frame, CORNERS_Y, CORNERS_X, SQUARE_SIZE, 
+                                     Projection::Projector(undistorter.get_camera_matrix(), cv::Mat()), rvecs.back(), tvecs.back());
+            }
+            else {
+                out_frame = last_valid_frame.clone();
+                Renderer::draw_board(out_frame, CORNERS_Y, CORNERS_X, SQUARE_SIZE, 
+                                     Projection::Projector(calibrator.get_camera_matrix(), calibrator.get_dist_coeffs()), rvecs.back(), tvecs.back());
+            }
+
+            // Draw text
+            Renderer::draw_text(out_frame, "Chessboard base", {30,30}, 1.0, cv::Scalar(255,255,255));
+
+            // Save the final frame in the background, waiting for room rather than dropping it
+            std::string filename = Utils::filename_timestamp("final_frame", image_writer.get_format());
+            image_writer.write(filename, out_frame, true);
+            std::cout << "Saving final frame as " << filename << std::endl;
+
+            // Show the final frame at window size until user exits
+            scaler.plan(out_frame.size());
+            scaler.apply(out_frame, shown);
+            display.post(shown);
+            // Wait until user exits
+            while (true) {
+                int key = display.wait_key(0);
+                if (key == KEY_ESCAPE || key == 'q') {
+                    break;
                 }
             }
         }
     }
 
+    // Finish the pending images before exiting
+    image_writer.close();
+    if (image_writer.get_written() + image_writer.get_dropped() + image_writer.get_failed() > 0) {
+        std::cout << "Saved " << image_writer.get_written() << " images, dropped " << image_writer.get_dropped()
+                  << ", failed " << image_writer.get_failed() << std::endl;
+    }
     return 0;
 }
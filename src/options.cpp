@@ -0,0 +1,162 @@
+#include "options.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+
+/**
+ * @brief Parse the command line into an Options structure
+ *
+ * The first argument that is not a flag is taken as the still frames directory.
+ * Flags that expect a value but are missing one, or have an invalid one, are ignored with a warning
+ * @param argc Argument count
+ * @param argv Argument values
+ * @return Parsed options, defaults for anything not given
+ */
+Options Options::parse(int argc, char** argv) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        // Read the string following a flag, if any
+        auto next_string = [&](std::string& value) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << ", ignored." << '\n';
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+
+        // Read the number following a flag, if any
+        auto next_value = [&](double& value) {
+            std::string text;
+            if (!next_string(text)) {
+                return false;
+            }
+            try {
+                value = std::stod(text);
+                return true;
+            }
+            catch (...) {
+                std::cerr << "Invalid value for " << arg << ", ignored." << '\n';
+                return false;
+            }
+        };
+
+        double value = 0.0;
+        if (arg == "--verbose" || arg == "-v") {
+            options.verbose = true;
+        }
+        else if (arg == "--min-frames") {
+            if (next_value(value)) { options.convergence.min_samples = (int)value; }
+        }
+        else if (arg == "--max-frames") {
+            if (next_value(value)) { options.max_camera_frames = (int)value; }
+        }
+        else if (arg == "--std-focal") {
+            if (next_value(value)) { options.convergence.focal_std = value; }
+        }
+        else if (arg == "--std-center") {
+            if (next_value(value)) { options.convergence.principal_std = value; }
+        }
+        else if (arg == "--std-dist") {
+            if (next_value(value)) { options.convergence.distortion_std = value; }
+        }
+        else if (arg == "--store") {
+            next_string(options.store_dir);
+        }
+        else if (arg == "--resolve") {
+            next_string(options.resolve_dir);
+        }
+        else if (arg == "--resolve-max") {
+            if (next_value(value)) { options.resolve_max = (int)value; }
+        }
+        else if (arg == "--stereo") {
+            std::string left, right;
+            if (next_string(left) && next_string(right)) { options.stereo_sources = { left, right }; }
+        }
+        else if (arg == "--track") {
+            next_string(options.track_file);
+        }
+        else if (arg == "--publish") {
+            next_string(options.publish_file);
+        }
+        else if (arg == "--publish-socket") {
+            next_string(options.publish_socket);
+        }
+        else if (arg == "--publish-binary") {
+            options.publish_binary = true;
+        }
+        else if (arg == "--batch") {
+            next_string(options.batch_list);
+        }
+        else if (arg == "--batch-out") {
+            next_string(options.batch_dir);
+        }
+        else if (arg == "--record") {
+            next_string(options.record_file);
+        }
+        else if (arg == "--record-codec") {
+            next_string(options.record_codec);
+        }
+        else if (arg == "--record-fps") {
+            if (next_value(value) && value > 0.0) { options.record_fps = value; }
+        }
+        else if (arg == "--save-frames") {
+            next_string(options.save_dir);
+        }
+        else if (arg == "--save-format") {
+            next_string(options.save_format);
+        }
+        else if (arg == "--save-level") {
+            if (next_value(value)) { options.save_level = (int)value; }
+        }
+        else if (arg == "--hold") {
+            if (next_value(value)) { options.hold_ms = std::max(0, (int)value); }
+        }
+        else if (arg == "--jobs") {
+            if (next_value(value)) { options.jobs = std::max(0, (int)value); }
+        }
+        else if (arg == "--threads") {
+            if (next_value(value)) { options.threads = std::max(0, (int)value); }
+        }
+        else if (arg == "--pin") {
+            std::string pin;
+            if (next_string(pin)) { options.pins.push_back(pin); }
+        }
+        else if (arg == "--capture-fifo") {
+            if (next_value(value)) { options.capture_priority = std::max(0, (int)value); }
+        }
+        else if (arg == "--markers") {
+            options.markers = true;
+        }
+        else if (arg == "--undistort") {
+            options.undistort = true;
+        }
+        else if (arg == "--export") {
+            next_string(options.export_dir);
+        }
+        else if (arg == "--rig") {
+            // Comma-separated list of sources
+            std::string list;
+            if (next_string(list)) {
+                std::stringstream stream(list);
+                std::string source;
+                while (std::getline(stream, source, ',')) {
+                    if (!source.empty()) { options.rig_sources.push_back(source); }
+                }
+            }
+        }
+        else if (!arg.empty() && arg[0] != '-') {
+            options.frames_dir = arg;
+        }
+        else {
+            std::cerr << "Unknown option " << arg << ", ignored." << '\n';
+        }
+    }
+
+    return options;
+}
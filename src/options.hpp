@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "calibrator.hpp"
+
+
+/**
+ * @brief Command line options of a Checkmate session
+ *
+ * Usage: Checkmate [frames_dir] [--verbose] [--min-frames N] [--max-frames N]
+ *                  [--std-focal PX] [--std-center PX] [--std-dist V]
+ *                  [--store DIR] [--resolve DIR] [--resolve-max N]
+ *                  [--stereo LEFT RIGHT] [--rig SRC,SRC,...] [--export DIR] [--undistort]
+ *                  [--track CALIBRATION] [--publish FILE] [--publish-socket PATH] [--publish-binary]
+ *                  [--batch LIST] [--batch-out DIR] [--markers]
+ *                  [--record FILE] [--record-codec FOURCC] [--record-fps FPS]
+ *                  [--save-frames DIR] [--save-format png|jpg|webp] [--save-level N] [--hold MS] [--jobs N] [--threads N]
+ *                  [--pin ROLE=CPUS] [--capture-fifo PRIO]
+ */
+struct Options {
+    bool verbose = false;                   // Print per-candidate pose diagnostics
+    std::string frames_dir = "res/frames";  // Directory with still frames
+    int max_camera_frames = 30;             // Upper bound on accepted samples in camera mode
+    ConvergenceTargets convergence;         // Uncertainty targets for early stopping
+    std::string store_dir;                  // Corner store to append accepted detections to, empty for none
+    std::string resolve_dir;                // Corner store to calibrate from offline, empty for a live session
+    int resolve_max = 0;                    // Maximum samples used for an offline calibration, 0 for all
+    std::vector<std::string> stereo_sources;  // Left and right source, camera index or directory, empty for mono
+    std::vector<std::string> rig_sources;     // Sources of a multi-camera rig, empty for none
+    std::string export_dir;                 // Directory for overlays of all accepted frames, empty for none
+    bool undistort = false;                 // Show and export calibrated frames undistorted
+    std::string track_file;                 // Saved calibration for tracking only, empty to calibrate
+    std::string publish_file;               // File to stream per-frame poses to, empty for none
+    std::string publish_socket;             // Unix domain socket to stream per-frame poses to, empty for none
+    bool publish_binary = false;            // Stream fixed-size binary records instead of JSON lines
+    bool markers = false;                   // Draw a marker on every square while tracking
+    std::string batch_list;                 // File listing dataset directories to calibrate in batch, empty for none
+    std::string batch_dir = "batch";        // Output directory of a batch run
+    std::string record_file;                // Video file to record the annotated live session to, empty for none
+    std::string record_codec = "MJPG";      // Four-character code of the recording codec
+    double record_fps = 30.0;               // Frame rate written to the recording
+    std::string save_dir;                   // Directory for every accepted frame with its overlay, empty for none
+    std::string save_format = "png";        // Format of saved images: png, jpg, or webp
+    int save_level = -1;                    // PNG compression 0-9 or JPEG/WebP quality 0-100, negative for the default
+    int hold_ms = 1000;                     // Time a counted frame stays on screen while processing continues, 0 for none
+    int jobs = 0;                           // Still frames processed concurrently, 0 for the thread budget, 1 for sequential
+    int threads = 0;                        // Threads shared by our workers and OpenCV, 0 for all hardware threads
+    std::vector<std::string> pins;          // CPUs per thread role, ROLE=CPUS with ROLE capture, detect, render (tracking only), or display
+    int capture_priority = 0;               // SCHED_FIFO priority of the tracking capture thread, 0 for the default policy
+
+    /**
+     * @brief Parse the command line into an Options structure
+     * @param argc Argument count
+     * @param argv Argument values
+     * @return Parsed options, defaults for anything not given
+     */
+    static Options parse(int argc, char** argv);
+};
@@ -0,0 +1,178 @@
+#include "overlay_layer.hpp"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+
+/**
+ * @brief Blend one row of BGRA overlay pixels over BGR frame pixels
+ *
+ * out = (frame * (255 - a) + overlay * a) / 255, rounded, sixteen pixels per iteration with universal
+ * intrinsics; blocks that are fully transparent are skipped
+ * @param dst BGR frame row, blended in place
+ * @param src BGRA overlay row
+ * @param width Number of pixels
+ */
+static void blend_row(uchar* dst, const uchar* src, int width) {
+    int x = 0;
+
+#if CV_SIMD128
+    const cv::v_uint16x8 v255 = cv::v_setall_u16(255);
+    const cv::v_uint16x8 round = cv::v_setall_u16(128);
+    const cv::v_uint8x16 transparent = cv::v_setzero_u8();
+
+    for (; x + 16 <= width; x += 16) {
+        cv::v_uint8x16 ob, og, or_, oa;
+        cv::v_load_deinterleave(src + x * 4, ob, og, or_, oa);
+        if (cv::v_check_all(oa == transparent)) {
+            continue;
+        }
+
+        cv::v_uint16x8 a0, a1;
+        cv::v_expand(oa, a0, a1);
+        cv::v_uint16x8 ia0 = v255 - a0, ia1 = v255 - a1;
+
+        // Blend one channel of sixteen pixels, divide by 255 with rounding
+        auto mix = [&](const cv::v_uint8x16& d, const cv::v_uint8x16& o) {
+            cv::v_uint16x8 d0, d1, o0, o1;
+            cv::v_expand(d, d0, d1);
+            cv::v_expand(o, o0, o1);
+            cv::v_uint16x8 t0 = d0 * ia0 + o0 * a0 + round;
+            cv::v_uint16x8 t1 = d1 * ia1 + o1 * a1 + round;
+            t0 = cv::v_shr<8>(t0 + cv::v_shr<8>(t0));
+            t1 = cv::v_shr<8>(t1 + cv::v_shr<8>(t1));
+            return cv::v_pack(t0, t1);
+        };
+
+        cv::v_uint8x16 db, dg, dr;
+        cv::v_load_deinterleave(dst + x * 3, db, dg, dr);
+        cv::v_store_interleave(dst + x * 3, mix(db, ob), mix(dg, og), mix(dr, or_));
+    }
+#endif
+
+    for (; x < width; ++x) {
+        const uchar* o = src + x * 4;
+        uchar* d = dst + x * 3;
+        int a = o[3];
+        if (a == 0) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            int t = d[k] * (255 - a) + o[k] * a + 128;
+            d[k] = (uchar)((t + (t >> 8)) >> 8);
+        }
+    }
+}
+
+
+/**
+ * @brief Start a new overlay if the content changed
+ *
+ * Clear only the dirty rectangles of the previous overlay, the rest of the canvas is still transparent
+ * @param size Frame size, the canvas is reallocated and redrawn when it changes
+ * @param content_key Hash of everything the overlay shows
+ * @return true if the caller must draw the overlay, the canvas is cleared, false to keep the previous one
+ */
+bool OverlayLayer::update(cv::Size size, uint64_t content_key) {
+    if (canvas_.size() != size) {
+        canvas_ = cv::Mat::zeros(size, CV_8UC4);
+        dirty_.clear();
+        valid_ = false;
+    }
+    if (valid_ && content_key == content_key_) {
+        return false;
+    }
+
+    for (const auto& region : dirty_) {
+        canvas_(region).setTo(cv::Scalar::all(0));
+    }
+    dirty_.clear();
+    content_key_ = content_key;
+    valid_ = true;
+    return true;
+}
+
+/**
+ * @brief Get the BGRA canvas to draw on, opaque colors need an alpha of 255
+ * @return Reference to the canvas
+ */
+cv::Mat& OverlayLayer::canvas() {
+    return canvas_;
+}
+
+/**
+ * @brief Mark a region of the canvas as drawn
+ *
+ * Merge the region with every rectangle it overlaps, until no two rectangles overlap
+ * @param region Region in canvas coordinates, clipped to the canvas
+ */
+void OverlayLayer::mark_dirty(const cv::Rect& region) {
+    cv::Rect merged = region & cv::Rect(0, 0, canvas_.cols, canvas_.rows);
+    if (merged.empty()) {
+        return;
+    }
+
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        for (size_t i = 0; i < dirty_.size(); ++i) {
+            if ((dirty_[i] & merged).empty()) {
+                continue;
+            }
+            merged |= dirty_[i];
+            dirty_.erase(dirty_.begin() + i);
+            grown = true;
+            break;
+        }
+    }
+    dirty_.push_back(merged);
+}
+
+/**
+ * @brief Copy a frame and blend the overlay onto the copy
+ * @param frame Clean BGR frame, not modified
+ * @param out Output BGR frame, reused across calls
+ */
+void OverlayLayer::composite(const cv::Mat& frame, cv::Mat& out) const {
+    frame.copyTo(out);
+    blend(out);
+}
+
+/**
+ * @brief Blend the overlay onto an image in place
+ * @param image BGR image of the canvas size, e.g. a preview that is already a copy of the frame
+ */
+void OverlayLayer::blend(cv::Mat& image) const {
+    CV_Assert(image.type() == CV_8UC3);
+    if (canvas_.size() != image.size()) {
+        return;
+    }
+
+    for (const auto& region : dirty_) {
+        for (int y = region.y; y < region.y + region.height; ++y) {
+            blend_row(image.ptr<uchar>(y) + region.x * 3, canvas_.ptr<uchar>(y) + region.x * 4, region.width);
+        }
+    }
+}
+
+/**
+ * @brief Get the regions covered by the current overlay
+ * @return Non-overlapping dirty rectangles
+ */
+const std::vector<cv::Rect>& OverlayLayer::get_dirty_rects() const {
+    return dirty_;
+}
+
+/**
+ * @brief Mix a block of bytes into a content key, FNV-1a
+ * @param data Bytes to mix
+ * @param size Number of bytes
+ * @param seed Key to extend, the FNV offset basis to start a new key
+ * @return Extended key
+ */
+uint64_t OverlayLayer::hash(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        seed = (seed ^ bytes[i]) * 1099511628211ull;
+    }
+    return seed;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+
+/**
+ * @class OverlayLayer
+ * @brief Transparent BGRA canvas composited onto frames without modifying them
+ *
+ * The canvas is redrawn only when the content key changes. Drawing code reports the regions it
+ * touched as dirty rectangles; a redraw clears only those, and compositing copies the frame and blends
+ * only those, with SIMD. Overlapping rectangles are merged so every pixel is blended once
+ */
+class OverlayLayer {
+public:
+    /**
+     * @brief Start a new overlay if the content changed
+     * @param size Frame size, the canvas is reallocated and redrawn when it changes
+     * @param content_key Hash of everything the overlay shows
+     * @return true if the caller must draw the overlay, the canvas is cleared, false to keep the previous one
+     */
+    bool update(cv::Size size, uint64_t content_key);
+
+    /**
+     * @brief Get the BGRA canvas to draw on, opaque colors need an alpha of 255
+     * @return Reference to the canvas
+     */
+    cv::Mat& canvas();
+
+    /**
+     * @brief Mark a region of the canvas as drawn
+     * @param region Region in canvas coordinates, clipped to the canvas
+     */
+    void mark_dirty(const cv::Rect& region);
+
+    /**
+     * @brief Copy a frame and blend the overlay onto the copy
+     * @param frame Clean BGR frame, not modified
+     * @param out Output BGR frame, reused across calls
+     */
+    void composite(const cv::Mat& frame, cv::Mat& out) const;
+
+    /**
+     * @brief Blend the overlay onto an image in place
+     * @param image BGR image of the canvas size, e.g. a preview that is already a copy of the frame
+     */
+    void blend(cv::Mat& image) const;
+
+    /**
+     * @brief Get the regions covered by the current overlay
+     * @return Non-overlapping dirty rectangles
+     */
+    const std::vector<cv::Rect>& get_dirty_rects() const;
+
+    /**
+     * @brief Mix a block of bytes into a content key, FNV-1a
+     * @param data Bytes to mix
+     * @param size Number of bytes
+     * @param seed Key to extend, the FNV offset basis to start a new key
+     * @return Extended key
+     */
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
+private:
+    cv::Mat canvas_;                    // CV_8UC4, transparent where nothing is drawn
+    std::vector<cv::Rect> dirty_;
+    uint64_t content_key_ = 0;
+    bool valid_ = false;                // The canvas holds the overlay of content_key_
+};
@@ -0,0 +1,193 @@
+#include "overlay_scene.hpp"
+
+#include <opencv2/imgproc.hpp>
+
+#include "glyph_atlas.hpp"
+
+
+constexpr const float CUBE_SCALE = 1.0f;
+
+
+/**
+ * @brief Add a line segment between two 3D points
+ * @param from Start point, board coordinates
+ * @param to End point, board coordinates
+ * @param color Line color
+ * @param thickness Line thickness in pixels
+ */
+void OverlayScene::add_line(const cv::Point3f& from, const cv::Point3f& to, cv::Scalar color, int thickness) {
+    int a = add_point(from);
+    int b = add_point(to);
+    primitives_.push_back({ Primitive::Kind::Line, a, b, color, thickness, 0.0, std::string() });
+}
+
+/**
+ * @brief Add text anchored at a 3D point, the bottom-left corner of the text
+ * @param anchor Anchor point, board coordinates
+ * @param text Text to draw
+ * @param color Text color
+ * @param scale Font scale
+ * @param thickness Stroke thickness in pixels
+ */
+void OverlayScene::add_text(const cv::Point3f& anchor, const std::string& text, cv::Scalar color, double scale, int thickness) {
+    primitives_.push_back({ Primitive::Kind::Text, add_point(anchor), -1, color, thickness, scale, text });
+}
+
+/**
+ * @brief Add a filled dot at a 3D point
+ * @param center Center point, board coordinates
+ * @param radius Radius in pixels
+ * @param color Fill color
+ */
+void OverlayScene::add_dot(const cv::Point3f& center, int radius, cv::Scalar color) {
+    primitives_.push_back({ Primitive::Kind::Dot, add_point(center), -1, color, radius, 0.0, std::string() });
+}
+
+/**
+ * @brief Add 3D axes, X green, Y red, Z blue
+ * @param offset 3D offset for the axes origin
+ */
+void OverlayScene::add_axes(const cv::Point3f& offset) {
+    add_line(offset, offset + cv::Point3f(0.0f, 4.0f, 0.0f), cv::Scalar(0,0,255));   // Y: red
+    add_line(offset, offset + cv::Point3f(4.0f, 0.0f, 0.0f), cv::Scalar(0,255,0));   // X: green
+    add_line(offset, offset + cv::Point3f(0.0f, 0.0f,-4.0f), cv::Scalar(255,0,0));   // Z: blue, negative for OpenCV
+}
+
+/**
+ * @brief Add the edges of a unit cube
+ *
+ * The 8 corners are added once and shared by the 12 edges
+ * @param base 3D base corner of the cube
+ * @param color Color of the cube edges
+ */
+void OverlayScene::add_cube(const cv::Point3f& base, cv::Scalar color) {
+    const float s = CUBE_SCALE;
+    int first = (int)points_.size();
+    const cv::Point3f corners[8] = {
+        {0, 0, 0}, {0, s, 0}, {s, 0, 0}, {0, 0, -s},
+        {s, s, 0}, {0, s, -s}, {s, 0, -s}, {s, s, -s}
+    };
+    for (const auto& c : corners) {
+        add_point(base + c);
+    }
+
+    // Bottom face, top face, verticals
+    const int edges[12][2] = {
+        {0,1}, {1,4}, {4,2}, {2,0},
+        {3,5}, {5,7}, {7,6}, {6,3},
+        {0,3}, {1,5}, {2,6}, {4,7}
+    };
+    for (const auto& e : edges) {
+        primitives_.push_back({ Primitive::Kind::Line, first + e[0], first + e[1], color, 2, 0.0, std::string() });
+    }
+}
+
+/**
+ * @brief Add chessboard row and column labels, A-H and 1-8
+ * @param rows Number of chessboard rows
+ * @param cols Number of chessboard columns
+ * @param square_size Size of each chessboard square
+ * @param offset 3D offset for the label origin
+ */
+void OverlayScene::add_labels(int rows, int cols, float square_size, const cv::Point3f& offset) {
+    // Row labels (A, B, ...)
+    for (int y = 0; y <= rows; ++y) {
+        add_text(offset + cv::Point3f(-0.5f * square_size, (y + 0.5f) * square_size, 0), std::string(1, ('A' + y)), cv::Scalar(0,0,0));
+    }
+
+    // Column labels (1, 2, ...)
+    for (int x = 0; x <= cols; ++x) {
+        add_text(offset + cv::Point3f((x + 0.5f) * square_size, -0.5f * square_size, 0), std::to_string(x+1), cv::Scalar(0,0,0));
+    }
+}
+
+/**
+ * @brief Project all points with one pose and draw the scene
+ * @param image Image on which to draw
+ * @param projector Projection kernel of the camera
+ * @param rvec Rotation vector, Rodrigues
+ * @param tvec Translation vector
+ * @return Region covered by the drawing
+ */
+cv::Rect OverlayScene::render(cv::Mat& image, const Projection::Projector& projector, const cv::Mat& rvec, const cv::Mat& tvec) const {
+    if (points_.empty()) {
+        return cv::Rect();
+    }
+
+    std::vector<cv::Point2f> proj(points_.size());
+    projector.project_fast(points_.data(), points_.size(), Projection::make_pose(rvec, tvec), proj.data());
+
+    cv::Rect bounds;
+    auto grow = [&](const cv::Rect& r) { bounds = bounds.empty() ? r : (bounds | r); };
+
+    for (const auto& p : primitives_) {
+        cv::Scalar color(p.color[0], p.color[1], p.color[2], 255);
+        switch (p.kind) {
+            case Primitive::Kind::Line: {
+                cv::line(image, proj[p.a], proj[p.b], color, p.thickness);
+                cv::Rect r = cv::boundingRect(std::vector<cv::Point2f>{ proj[p.a], proj[p.b] });
+                grow(r + cv::Size(2 * p.thickness + 2, 2 * p.thickness + 2) - cv::Point(p.thickness + 1, p.thickness + 1));
+                break;
+            }
+            case Primitive::Kind::Text: {
+                const GlyphAtlas& atlas = GlyphAtlas::get(p.scale, p.thickness);
+                atlas.draw(image, p.text, proj[p.a], color);
+                grow(atlas.get_bounds(p.text, proj[p.a]));
+                break;
+            }
+            case Primitive::Kind::Dot: {
+                cv::circle(image, proj[p.a], p.thickness, color, -1);
+                cv::Point c(cvRound(proj[p.a].x), cvRound(proj[p.a].y));
+                grow(cv::Rect(c.x - p.thickness - 1, c.y - p.thickness - 1, 2 * p.thickness + 3, 2 * p.thickness + 3));
+                break;
+            }
+        }
+    }
+    return bounds;
+}
+
+/**
+ * @brief Get the number of 3D points projected per render
+ * @return Number of points
+ */
+size_t OverlayScene::get_num_points() const {
+    return points_.size();
+}
+
+/**
+ * @brief Build the calibrated board overlay: axes, labels, cubes at E1 and E8, and the board origin
+ *
+ * The origin of the overlay is the outer corner of square A1, one square outside the first inner corner
+ * @param rows Number of chessboard rows
+ * @param cols Number of chessboard columns
+ * @param square_size Size of each chessboard square
+ * @return Scene in board coordinates
+ */
+OverlayScene OverlayScene::chessboard(int rows, int cols, float square_size) {
+    OverlayScene scene;
+
+    // Axes and labels
+    cv::Point3f outer_corner_offset(-square_size, -square_size, 0);
+    scene.add_axes(outer_corner_offset);
+    scene.add_labels(rows, cols, square_size, outer_corner_offset);
+
+    // White cube at E1 and black cube at E8
+    cv::Point3f e1_3d(-square_size, 3 * square_size, 0);
+    cv::Point3f e8_3d = e1_3d + cv::Point3f(rows * square_size, 0, 0);
+    scene.add_cube(e1_3d, cv::Scalar(255,255,255));
+    scene.add_cube(e8_3d, cv::Scalar(0,0,0));
+
+    // Board origin
+    scene.add_dot(outer_corner_offset, 10, cv::Scalar(0,0,255));
+    return scene;
+}
+
+/**
+ * @brief Append a point to the point list
+ * @param p Point, board coordinates
+ * @return Index of the point
+ */
+int OverlayScene::add_point(const cv::Point3f& p) {
+    points_.push_back(p);
+    return (int)points_.size() - 1;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "projection.hpp"
+
+
+/**
+ * @class OverlayScene
+ * @brief Retained-mode 3D overlay: a point list and a draw list built once, projected in one batch per pose
+ *
+ * Primitives reference points in the shared point list, so rendering a pose is a single projection
+ * of all points followed by 2D drawing, regardless of how many annotations the scene holds.
+ * Rendering does not modify the scene, so one scene can be rendered by several threads.
+ * Colors are drawn opaque, so a scene can be rendered onto a BGRA overlay canvas
+ */
+class OverlayScene {
+public:
+    /**
+     * @brief Add a line segment between two 3D points
+     * @param from Start point, board coordinates
+     * @param to End point, board coordinates
+     * @param color Line color
+     * @param thickness Line thickness in pixels
+     */
+    void add_line(const cv::Point3f& from, const cv::Point3f& to, cv::Scalar color, int thickness = 2);
+
+    /**
+     * @brief Add text anchored at a 3D point, the bottom-left corner of the text
+     * @param anchor Anchor point, board coordinates
+     * @param text Text to draw
+     * @param color Text color
+     * @param scale Font scale
+     * @param thickness Stroke thickness in pixels
+     */
+    void add_text(const cv::Point3f& anchor, const std::string& text, cv::Scalar color, double scale = 1.0, int thickness = 2);
+
+    /**
+     * @brief Add a filled dot at a 3D point
+     * @param center Center point, board coordinates
+     * @param radius Radius in pixels
+     * @param color Fill color
+     */
+    void add_dot(const cv::Point3f& center, int radius, cv::Scalar color);
+
+    /**
+     * @brief Add 3D axes, X green, Y red, Z blue
+     * @param offset 3D offset for the axes origin
+     */
+    void add_axes(const cv::Point3f& offset);
+
+    /**
+     * @brief Add the edges of a unit cube
+     * @param base 3D base corner of the cube
+     * @param color Color of the cube edges
+     */
+    void add_cube(const cv::Point3f& base, cv::Scalar color);
+
+    /**
+     * @brief Add chessboard row and column labels, A-H and 1-8
+     * @param rows Number of chessboard rows
+     * @param cols Number of chessboard columns
+     * @param square_size Size of each chessboard square
+     * @param offset 3D offset for the label origin
+     */
+    void add_labels(int rows, int cols, float square_size, const cv::Point3f& offset);
+
+    /**
+     * @brief Project all points with one pose and draw the scene
+     * @param image Image on which to draw
+     * @param projector Projection kernel of the camera
+     * @param rvec Rotation vector, Rodrigues
+     * @param tvec Translation vector
+     * @return Region covered by the drawing
+     */
+    cv::Rect render(cv::Mat& image, const Projection::Projector& projector, const cv::Mat& rvec, const cv::Mat& tvec) const;
+
+    /**
+     * @brief Get the number of 3D points projected per render
+     * @return Number of points
+     */
+    size_t get_num_points() const;
+
+    /**
+     * @brief Build the calibrated board overlay: axes, labels, cubes at E1 and E8, and the board origin
+     * @param rows Number of chessboard rows
+     * @param cols Number of chessboard columns
+     * @param square_size Size of each chessboard square
+     * @return Scene in board coordinates
+     */
+    static OverlayScene chessboard(int rows, int cols, float square_size);
+
+private:
+    /**
+     * @brief One entry of the draw list
+     */
+    struct Primitive {
+        enum class Kind { Line, Text, Dot } kind;
+        int a;               // First point index
+        int b;               // Second point index, lines only
+        cv::Scalar color;
+        int thickness;       // Line and text thickness, dot radius
+        double scale;        // Font scale, text only
+        std::string text;
+    };
+
+    /**
+     * @brief Append a point to the point list
+     * @param p Point, board coordinates
+     * @return Index of the point
+     */
+    int add_point(const cv::Point3f& p);
+
+    std::vector<cv::Point3f> points_;
+    std::vector<Primitive> primitives_;
+};
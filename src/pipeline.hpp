@@ -0,0 +1,319 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "spsc_queue.hpp"
+
+
+/**
+ * @brief Counters of one pipeline stage, summed over its workers
+ */
+struct StageStats {
+    std::string name;
+    unsigned workers = 1;
+    uint64_t items = 0;          // Items processed
+    double busy_ms = 0.0;        // Time spent in the stage function
+    double starved_ms = 0.0;     // Time spent waiting for input
+    double blocked_ms = 0.0;     // Time spent waiting for room downstream, backpressure
+};
+
+/**
+ * @class Pipeline
+ * @brief Staged processing of a stream of items, every stage on its own threads, connected by bounded lock-free queues
+ *
+ * A source thread produces items numbered by a sequence number, each stage transforms them on one or
+ * more worker threads, and a sink receives them on the calling thread in sequence order. Worker j of a
+ * stage with n workers handles the items with seq % n == j, and every pair of workers in adjacent stages
+ * has its own single-producer single-consumer queue, so items stay in order without locks. A full
+ * queue blocks its producer, which propagates backpressure up to the source; in-flight memory is
+ * bounded by the queue capacities. Throughput is bounded by the slowest stage, which can be given
+ * more workers. Items for which a stage returns false skip the remaining stages but still reach the
+ * sink, so sequence numbers stay contiguous
+ * @tparam T Item type, default constructible and movable
+ */
+template <typename T>
+class Pipeline {
+public:
+    using Source = std::function<bool(T&)>;                 // Fill the next item, false at the end of the stream
+    using Stage = std::function<bool(T&)>;                  // Transform an item, false to skip the remaining stages
+    using Sink = std::function<void(uint64_t, T&, bool)>;   // Consume an item: seq, item, true if no stage skipped it
+    using ThreadInit = std::function<void(const std::string&)>;  // Called first on every pipeline thread: stage name, or "source"
+
+    /**
+     * @brief Construct a new Pipeline object
+     * @param capacity Number of items each queue between two workers can hold
+     */
+    explicit Pipeline(size_t capacity = 4) : capacity_(capacity) {}
+
+    /**
+     * @brief Append a stage
+     * @param name Stage name, for statistics
+     * @param fn Stage function, called concurrently by the workers when there are several
+     * @param workers Number of worker threads
+     */
+    void add_stage(const std::string& name, Stage fn, unsigned workers = 1) {
+        stages_.push_back({ name, std::move(fn), std::max(1u, workers) });
+    }
+
+    /**
+     * @brief Set a function called first on every thread the pipeline starts, e.g. to pin it to CPUs
+     * @param init Function of the stage name, "source" for the source thread
+     */
+    void set_thread_init(ThreadInit init) {
+        thread_init_ = std::move(init);
+    }
+
+    /**
+     * @brief Run the pipeline until the source ends or stop is called, the sink runs on the calling thread
+     * @param source Source function, called on its own thread
+     * @param sink Sink function, receives every item in sequence order
+     * @return Number of items that reached the sink
+     */
+    uint64_t run(Source source, Sink sink) {
+        // Layer 0 is the source, then one layer per stage, then the sink
+        std::vector<unsigned> widths = { 1 };
+        for (const auto& stage : stages_) {
+            widths.push_back(stage.workers);
+        }
+        widths.push_back(1);
+
+        links_.clear();
+        for (size_t l = 0; l + 1 < widths.size(); ++l) {
+            Link link;
+            link.producers = widths[l];
+            link.consumers = widths[l + 1];
+            for (unsigned q = 0; q < link.producers * link.consumers; ++q) {
+                link.queues.push_back(std::make_unique<SpscQueue<Packet>>(capacity_));
+            }
+            links_.push_back(std::move(link));
+        }
+        counters_ = std::vector<Counters>(stages_.size());
+        total_ = std::numeric_limits<uint64_t>::max();
+        stopping_ = false;
+
+        std::vector<std::thread> threads;
+        threads.emplace_back([this, &source]() { produce(source); });
+        for (size_t s = 0; s < stages_.size(); ++s) {
+            for (unsigned w = 0; w < stages_[s].workers; ++w) {
+                threads.emplace_back([this, s, w]() { work(s, w); });
+            }
+        }
+
+        uint64_t consumed = 0;
+        Packet packet;
+        for (uint64_t seq = 0; pop(links_.back(), 0, seq, packet, nullptr); ++seq) {
+            sink(seq, packet.item, packet.keep);
+            ++consumed;
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return consumed;
+    }
+
+    /**
+     * @brief Stop reading from the source, the items already produced still reach the sink
+     */
+    void stop() {
+        stopping_ = true;
+    }
+
+    /**
+     * @brief Get the counters of every stage, complete once run returns
+     * @return One entry per stage, in order
+     */
+    std::vector<StageStats> get_stats() const {
+        std::vector<StageStats> stats;
+        for (size_t s = 0; s < stages_.size() && s < counters_.size(); ++s) {
+            StageStats entry;
+            entry.name = stages_[s].name;
+            entry.workers = stages_[s].workers;
+            entry.items = counters_[s].items.load();
+            entry.busy_ms = counters_[s].busy_ns.load() * 1e-6;
+            entry.starved_ms = counters_[s].starved_ns.load() * 1e-6;
+            entry.blocked_ms = counters_[s].blocked_ns.load() * 1e-6;
+            stats.push_back(entry);
+        }
+        return stats;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int SPIN_LIMIT = 64;           // Failed attempts before a waiting thread sleeps
+    static constexpr int BACKOFF_US = 50;           // Sleep of a waiting thread
+
+    /**
+     * @brief Item with its sequence number
+     */
+    struct Packet {
+        uint64_t seq = 0;
+        bool keep = true;       // False once a stage skipped the item
+        T item;
+    };
+
+    /**
+     * @brief Queues between all workers of two adjacent layers, producer-major
+     */
+    struct Link {
+        unsigned producers = 1;
+        unsigned consumers = 1;
+        std::vector<std::unique_ptr<SpscQueue<Packet>>> queues;
+    };
+
+    /**
+     * @brief Stage definition
+     */
+    struct StageDef {
+        std::string name;
+        Stage fn;
+        unsigned workers;
+    };
+
+    /**
+     * @brief Stage counters, updated by all its workers
+     */
+    struct Counters {
+        std::atomic<uint64_t> items{0};
+        std::atomic<uint64_t> busy_ns{0};
+        std::atomic<uint64_t> starved_ns{0};
+        std::atomic<uint64_t> blocked_ns{0};
+    };
+
+    /**
+     * @brief Wait one backoff step
+     * @param spins Number of failed attempts so far, incremented
+     */
+    static void backoff(int& spins) {
+        if (++spins < SPIN_LIMIT) {
+            std::this_thread::yield();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::microseconds(BACKOFF_US));
+        }
+    }
+
+    /**
+     * @brief Get the elapsed time since a start point
+     * @param start Start point
+     * @return Nanoseconds since start
+     */
+    static uint64_t elapsed_ns(Clock::time_point start) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    /**
+     * @brief Pop the item with a given sequence number, waiting until it arrives or the stream ends
+     * @param link Link the consumer reads from
+     * @param consumer Consumer index in the link
+     * @param seq Expected sequence number, its producer is seq % producers
+     * @param packet Output packet
+     * @param waited Waiting time is added to it, may be null
+     * @return true if the item was popped, false if the stream ended before it
+     */
+    bool pop(Link& link, unsigned consumer, uint64_t seq, Packet& packet, std::atomic<uint64_t>* waited) {
+        SpscQueue<Packet>& queue = *link.queues[(seq % link.producers) * link.consumers + consumer];
+        if (queue.try_pop(packet)) {
+            return true;
+        }
+
+        auto start = Clock::now();
+        int spins = 0;
+        while (!queue.try_pop(packet)) {
+            // The end is published after the last push, so an item below it is on its way
+            if (seq >= total_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            backoff(spins);
+        }
+        if (waited) {
+            waited->fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Push an item to the consumer that handles its sequence number, waiting for room
+     * @param link Link the producer writes to
+     * @param producer Producer index in the link
+     * @param packet Packet to push, moved from
+     * @param waited Waiting time is added to it, may be null
+     */
+    void push(Link& link, unsigned producer, Packet&& packet, std::atomic<uint64_t>* waited) {
+        SpscQueue<Packet>& queue = *link.queues[producer * link.consumers + packet.seq % link.consumers];
+        if (queue.try_push(std::move(packet))) {
+            return;
+        }
+
+        auto start = Clock::now();
+        int spins = 0;
+        while (!queue.try_push(std::move(packet))) {
+            backoff(spins);
+        }
+        if (waited) {
+            waited->fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Source thread, read items until the source ends or the pipeline stops, then publish the count
+     * @param source Source function
+     */
+    void produce(Source& source) {
+        if (thread_init_) {
+            thread_init_("source");
+        }
+        uint64_t seq = 0;
+        while (!stopping_.load(std::memory_order_relaxed)) {
+            Packet packet;
+            if (!source(packet.item)) {
+                break;
+            }
+            packet.seq = seq++;
+            push(links_.front(), 0, std::move(packet), nullptr);
+        }
+        total_.store(seq, std::memory_order_release);
+    }
+
+    /**
+     * @brief Worker thread of a stage, process every item with seq % workers == worker in order
+     * @param s Stage index
+     * @param worker Worker index in the stage
+     */
+    void work(size_t s, unsigned worker) {
+        const StageDef& stage = stages_[s];
+        Counters& counters = counters_[s];
+        if (thread_init_) {
+            thread_init_(stage.name);
+        }
+        Packet packet;
+        for (uint64_t seq = worker; pop(links_[s], worker, seq, packet, &counters.starved_ns); seq += stage.workers) {
+            if (packet.keep) {
+                auto start = Clock::now();
+                packet.keep = stage.fn(packet.item);
+                counters.busy_ns.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+                counters.items.fetch_add(1, std::memory_order_relaxed);
+            }
+            push(links_[s + 1], worker, std::move(packet), &counters.blocked_ns);
+        }
+    }
+
+    size_t capacity_;
+    std::vector<StageDef> stages_;
+    ThreadInit thread_init_;
+    std::vector<Link> links_;               // links_[s] feeds stage s, the last one feeds the sink
+    std::vector<Counters> counters_;
+    std::atomic<uint64_t> total_{0};        // Number of items produced, maximum while the source runs
+    std::atomic<bool> stopping_{false};
+};
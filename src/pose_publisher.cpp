@@ -0,0 +1,304 @@
+#include "pose_publisher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+
+constexpr int DRAIN_INTERVAL_MS = 1;      // Sleep of the writer thread when the queue is empty
+constexpr size_t RECORD_SIZE = 80;        // Size of a binary record, see encode
+constexpr int LISTEN_BACKLOG = 8;
+constexpr int32_t FLAG_UNCALIBRATED = 1;  // Binary record flag, pose solved with default intrinsics
+
+#if defined(MSG_NOSIGNAL)
+constexpr int SEND_FLAGS = MSG_NOSIGNAL | MSG_DONTWAIT;
+#elif !defined(_WIN32)
+constexpr int SEND_FLAGS = MSG_DONTWAIT;
+#endif
+
+
+/**
+ * @brief Construct a new PosePublisher object and start the writer thread
+ * @param file_path Output file, empty for none
+ * @param socket_path Unix domain socket to listen on, empty for none
+ * @param binary If true, write fixed-size binary records instead of JSON lines
+ * @param capacity Number of messages the queue can hold
+ */
+PosePublisher::PosePublisher(const std::string& file_path, const std::string& socket_path, bool binary, size_t capacity)
+    : binary_(binary), socket_path_(socket_path), queue_(capacity)
+{
+    if (!file_path.empty()) {
+        file_.open(file_path, binary ? std::ios::binary | std::ios::trunc : std::ios::trunc);
+        if (!file_.is_open()) {
+            std::cerr << "Could not open pose output " << file_path << '\n';
+        }
+    }
+
+    if (!socket_path_.empty()) {
+#if defined(_WIN32)
+        std::cerr << "Pose sockets are not supported on this platform, " << socket_path_ << " ignored." << '\n';
+#else
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socket_path_.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Pose socket path too long: " << socket_path_ << '\n';
+        }
+        else {
+            std::strncpy(addr.sun_path, socket_path_.c_str(), sizeof(addr.sun_path) - 1);
+            ::unlink(socket_path_.c_str());
+
+            listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (listen_fd_ >= 0) {
+                ::fcntl(listen_fd_, F_SETFL, ::fcntl(listen_fd_, F_GETFL, 0) | O_NONBLOCK);
+                if (::bind(listen_fd_, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listen_fd_, LISTEN_BACKLOG) != 0) {
+                    ::close(listen_fd_);
+                    listen_fd_ = -1;
+                }
+            }
+            if (listen_fd_ < 0) {
+                std::cerr << "Could not listen on pose socket " << socket_path_ << '\n';
+            }
+        }
+#endif
+    }
+
+    worker_ = std::thread(&PosePublisher::run, this);
+}
+
+/**
+ * @brief Flush the queued messages, stop the writer thread, and close all outputs
+ */
+PosePublisher::~PosePublisher() {
+    close();
+
+#if !defined(_WIN32)
+    for (const auto& client : clients_) {
+        ::close(client.fd);
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(socket_path_.c_str());
+    }
+#endif
+}
+
+/**
+ * @brief Queue a pose for publishing, never blocks, to be called from a single thread
+ * @param message Pose of one frame
+ * @return true if the message was queued, false if it was dropped
+ */
+bool PosePublisher::publish(const PoseMessage& message) {
+    if (!running_.load(std::memory_order_relaxed) || !queue_.try_push(message)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    published_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Write all queued messages and stop the writer thread, later messages are dropped
+ */
+void PosePublisher::close() {
+    running_ = false;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+/**
+ * @brief Check if at least one output could be opened
+ * @return true if the file or the socket is open
+ */
+bool PosePublisher::is_opened() const {
+    return file_.is_open() || listen_fd_ >= 0;
+}
+
+/**
+ * @brief Get the number of messages queued for publishing
+ * @return Number of accepted messages
+ */
+uint64_t PosePublisher::get_published() const {
+    return published_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the number of messages dropped because the queue was full
+ * @return Number of dropped messages
+ */
+uint64_t PosePublisher::get_dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the number of messages a socket client missed because it was too slow
+ * @return Number of missed messages summed over all clients
+ */
+uint64_t PosePublisher::get_client_dropped() const {
+    return client_dropped_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the current time in the timestamp format of PoseMessage
+ * @return Microseconds since the Unix epoch
+ */
+int64_t PosePublisher::now_us() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Writer thread loop, drain the queue and accept clients until stopped
+ *
+ * All messages available at once are encoded into one buffer, so a burst costs one file write
+ * and one send per client. The queue is drained completely before the thread exits
+ */
+void PosePublisher::run() {
+    std::string batch;
+    PoseMessage message;
+
+    while (true) {
+        bool stopping = !running_.load();
+        accept_clients();
+
+        batch.clear();
+        size_t count = 0;
+        while (queue_.try_pop(message)) {
+            encode(message, batch);
+            ++count;
+        }
+
+        if (count > 0) {
+            if (file_.is_open()) {
+                file_.write(batch.data(), (std::streamsize)batch.size());
+                file_.flush();
+            }
+            send_to_clients(batch, count);
+        }
+        else if (stopping) {
+            break;
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+        }
+    }
+}
+
+/**
+ * @brief Serialize a message in the configured format
+ *
+ * A binary record is 80 bytes in host byte order: frame id and timestamp as int64, A1 index and flags
+ * as int32, then the reprojection error, rvec, and tvec as doubles. Flag bit 0 marks an uncalibrated pose
+ * @param message Pose of one frame
+ * @param out Output buffer, the message is appended
+ */
+void PosePublisher::encode(const PoseMessage& message, std::string& out) const {
+    if (binary_) {
+        char record[RECORD_SIZE] = {};
+        int32_t a1_index = message.a1_index;
+        int32_t flags = message.uncalibrated ? FLAG_UNCALIBRATED : 0;
+        std::memcpy(record, &message.frame_id, 8);
+        std::memcpy(record + 8, &message.timestamp_us, 8);
+        std::memcpy(record + 16, &a1_index, 4);
+        std::memcpy(record + 20, &flags, 4);
+        std::memcpy(record + 24, &message.reproj_error, 8);
+        std::memcpy(record + 32, message.rvec, 24);
+        std::memcpy(record + 56, message.tvec, 24);
+        out.append(record, RECORD_SIZE);
+        return;
+    }
+
+    char line[320];
+    int length = std::snprintf(line, sizeof(line),
+        "{\"frame\":%lld,\"timestamp_us\":%lld,\"a1\":%d,\"reproj_error\":%.4f,"
+        "\"rvec\":[%.9g,%.9g,%.9g],\"tvec\":[%.9g,%.9g,%.9g],\"uncalibrated\":%s}\n",
+        (long long)message.frame_id, (long long)message.timestamp_us, message.a1_index, message.reproj_error,
+        message.rvec[0], message.rvec[1], message.rvec[2], message.tvec[0], message.tvec[1], message.tvec[2],
+        message.uncalibrated ? "true" : "false");
+    if (length > 0) {
+        out.append(line, std::min<size_t>((size_t)length, sizeof(line) - 1));
+    }
+}
+
+/**
+ * @brief Accept pending socket connections without blocking
+ *
+ * Accepted sockets are non-blocking and, where the platform has SO_NOSIGPIPE, never raise SIGPIPE
+ */
+void PosePublisher::accept_clients() {
+#if !defined(_WIN32)
+    if (listen_fd_ < 0) {
+        return;
+    }
+    while (true) {
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            break;
+        }
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#if defined(SO_NOSIGPIPE)
+        // Without MSG_NOSIGNAL, e.g. on macOS, a send to a disconnected client would raise SIGPIPE
+        int no_sigpipe = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+        clients_.push_back({ fd, std::string() });
+    }
+#endif
+}
+
+/**
+ * @brief Send an encoded batch to all socket clients without blocking
+ *
+ * A client that still has the tail of an earlier message pending gets that tail first and misses the
+ * batch if the tail does not go through, so clients always receive whole messages. Disconnected
+ * clients are removed
+ * @param data Encoded messages
+ * @param count Number of messages in data
+ */
+void PosePublisher::send_to_clients(const std::string& data, size_t count) {
+#if !defined(_WIN32)
+    // Send as much of a buffer as the socket accepts, false if the client is gone
+    auto send_some = [](int fd, std::string& buffer) {
+        while (!buffer.empty()) {
+            ssize_t sent = ::send(fd, buffer.data(), buffer.size(), SEND_FLAGS);
+            if (sent < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+            buffer.erase(0, (size_t)sent);
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i < clients_.size();) {
+        Client& client = clients_[i];
+        bool alive = send_some(client.fd, client.pending);
+        if (alive && client.pending.empty()) {
+            client.pending = data;
+            alive = send_some(client.fd, client.pending);
+        }
+        else if (alive) {
+            client_dropped_.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        if (!alive) {
+            ::close(client.fd);
+            clients_.erase(clients_.begin() + i);
+            continue;
+        }
+        ++i;
+    }
+#else
+    (void)data;
+    (void)count;
+#endif
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_queue.hpp"
+
+
+/**
+ * @brief Board pose of one frame as published to downstream consumers
+ */
+struct PoseMessage {
+    int64_t frame_id = 0;        // Index of the frame in the session
+    int64_t timestamp_us = 0;    // Frame arrival, microseconds since the Unix epoch
+    int a1_index = -1;           // Outer corner used as A1, 0=TL, 1=TR, 2=BL, 3=BR
+    double reproj_error = 0.0;   // Mean reprojection error of the pose, in pixels
+    double rvec[3] = {};         // Board rotation, Rodrigues
+    double tvec[3] = {};         // Board translation, in square units
+    bool uncalibrated = false;   // Solved with default intrinsics during calibration, not the true board pose
+};
+
+/**
+ * @class PosePublisher
+ * @brief Stream board poses to a file and to local socket clients without blocking the caller
+ *
+ * Poses are queued in a lock-free queue and written by a background thread, either as JSON lines
+ * or as fixed-size binary records. Socket clients connect to a Unix domain socket; a client
+ * that cannot keep up misses messages instead of stalling the others. Messages that do not fit in
+ * the queue or in a client socket are counted as dropped
+ */
+class PosePublisher {
+public:
+    /**
+     * @brief Construct a new PosePublisher object and start the writer thread
+     * @param file_path Output file, empty for none
+     * @param socket_path Unix domain socket to listen on, empty for none
+     * @param binary If true, write fixed-size binary records instead of JSON lines
+     * @param capacity Number of messages the queue can hold
+     */
+    PosePublisher(const std::string& file_path, const std::string& socket_path, bool binary = false, size_t capacity = 1024);
+
+    /**
+     * @brief Flush the queued messages, stop the writer thread, and close all outputs
+     */
+    ~PosePublisher();
+
+    PosePublisher(const PosePublisher&) = delete;
+    PosePublisher& operator=(const PosePublisher&) = delete;
+
+    /**
+     * @brief Queue a pose for publishing, never blocks, to be called from a single thread
+     * @param message Pose of one frame
+     * @return true if the message was queued, false if it was dropped
+     */
+    bool publish(const PoseMessage& message);
+
+    /**
+     * @brief Write all queued messages and stop the writer thread, later messages are dropped
+     */
+    void close();
+
+    /**
+     * @brief Check if at least one output could be opened
+     * @return true if the file or the socket is open
+     */
+    bool is_opened() const;
+
+    /**
+     * @brief Get the number of messages queued for publishing
+     * @return Number of accepted messages
+     */
+    uint64_t get_published() const;
+
+    /**
+     * @brief Get the number of messages dropped because the queue was full
+     * @return Number of dropped messages
+     */
+    uint64_t get_dropped() const;
+
+    /**
+     * @brief Get the number of messages a socket client missed because it was too slow
+     * @return Number of missed messages summed over all clients
+     */
+    uint64_t get_client_dropped() const;
+
+    /**
+     * @brief Get the current time in the timestamp format of PoseMessage
+     * @return Microseconds since the Unix epoch
+     */
+    static int64_t now_us();
+
+private:
+    /**
+     * @brief Socket client with the unsent tail of a partially written message
+     */
+    struct Client {
+        int fd;
+        std::string pending;
+    };
+
+    /**
+     * @brief Writer thread loop, drain the queue and accept clients until stopped
+     */
+    void run();
+
+    /**
+     * @brief Serialize a message in the configured format
+     * @param message Pose of one frame
+     * @param out Output buffer, the message is appended
+     */
+    void encode(const PoseMessage& message, std::string& out) const;
+
+    /**
+     * @brief Accept pending socket connections without blocking
+     */
+    void accept_clients();
+
+    /**
+     * @brief Send an encoded batch to all socket clients without blocking
+     * @param data Encoded messages
+     * @param count Number of messages in data
+     */
+    void send_to_clients(const std::string& data, size_t count);
+
+    bool binary_;
+    std::ofstream file_;
+    std::string socket_path_;
+    int listen_fd_ = -1;
+    std::vector<Client> clients_;
+
+    SpscQueue<PoseMessage> queue_;
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> client_dropped_{0};
+    std::thread worker_;
+};
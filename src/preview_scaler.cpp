@@ -0,0 +1,101 @@
+#include "preview_scaler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+constexpr double SNAP_TOLERANCE = 0.05;   // Relative distance to an integer factor that is snapped to it
+
+
+/**
+ * @brief Construct a new PreviewScaler object
+ * @param max_size Largest preview size, usually the window size
+ */
+PreviewScaler::PreviewScaler(cv::Size max_size) : max_size_(max_size) {}
+
+/**
+ * @brief Build the resize plan for a frame size, if it changed
+ * @param frame_size Size of the full-resolution frames
+ * @return true if the plan was rebuilt, scaled camera matrices must be recomputed
+ */
+bool PreviewScaler::plan(cv::Size frame_size) {
+    if (frame_size == frame_size_) {
+        return false;
+    }
+    frame_size_ = frame_size;
+
+    double fit = std::min((double)max_size_.width / std::max(frame_size.width, 1),
+                          (double)max_size_.height / std::max(frame_size.height, 1));
+    scale_ = std::min(fit, 1.0);
+
+    // Snap down to 1/n when close, area resampling has a fast path for integer factors
+    double factor = 1.0 / scale_;
+    double n = std::ceil(factor);
+    if (n > 1.0 && n - factor <= SNAP_TOLERANCE * n) {
+        scale_ = 1.0 / n;
+    }
+
+    preview_size_ = cv::Size(std::max(1, (int)std::lround(frame_size.width * scale_)),
+                             std::max(1, (int)std::lround(frame_size.height * scale_)));
+    return true;
+}
+
+/**
+ * @brief Downsample a frame to the preview size
+ * @param frame Full-resolution frame of the planned size
+ * @param preview Output preview, a copy of the frame if no scaling is needed, reused across calls
+ */
+void PreviewScaler::apply(const cv::Mat& frame, cv::Mat& preview) const {
+    if (preview_size_ == frame.size()) {
+        frame.copyTo(preview);
+        return;
+    }
+    cv::resize(frame, preview, preview_size_, 0, 0, cv::INTER_AREA);
+}
+
+/**
+ * @brief Map a camera matrix to preview pixel coordinates, distortion coefficients are unchanged
+ *
+ * Pixel centers are mapped like the resize, u' = (u + 0.5) * scale - 0.5
+ * @param K 3x3 camera matrix of the full-resolution frame
+ * @return 3x3 camera matrix of the preview
+ */
+cv::Mat PreviewScaler::scale_camera_matrix(const cv::Mat& K) const {
+    cv::Mat scaled;
+    K.convertTo(scaled, CV_64F);
+    scaled.row(0) *= scale_;
+    scaled.row(1) *= scale_;
+    scaled.at<double>(0, 2) += 0.5 * scale_ - 0.5;
+    scaled.at<double>(1, 2) += 0.5 * scale_ - 0.5;
+    return scaled;
+}
+
+/**
+ * @brief Map full-resolution image points to preview pixel coordinates
+ * @param points Points in frame coordinates
+ * @param scaled Output points in preview coordinates
+ */
+void PreviewScaler::scale_points(const std::vector<cv::Point2f>& points, std::vector<cv::Point2f>& scaled) const {
+    const float s = (float)scale_;
+    const float offset = 0.5f * s - 0.5f;
+    scaled.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        scaled[i] = cv::Point2f(points[i].x * s + offset, points[i].y * s + offset);
+    }
+}
+
+/**
+ * @brief Get the preview scale
+ * @return Preview pixels per frame pixel, at most 1
+ */
+double PreviewScaler::get_scale() const {
+    return scale_;
+}
+
+/**
+ * @brief Get the preview size
+ * @return Size of the planned preview
+ */
+cv::Size PreviewScaler::get_size() const {
+    return preview_size_;
+}
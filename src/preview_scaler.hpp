@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+
+/**
+ * @class PreviewScaler
+ * @brief Downsample frames to the display size with a resize plan cached per frame size
+ *
+ * The plan holds the scale and the preview size; it is rebuilt only when the
+ * frame size changes. Scales close to an integer fraction are snapped to it, so area resampling takes
+ * its integer-factor path. Overlays are drawn at preview resolution with coordinates mapped by the
+ * same scale, and frames that already fit are copied unscaled
+ */
+class PreviewScaler {
+public:
+    /**
+     * @brief Construct a new PreviewScaler object
+     * @param max_size Largest preview size, usually the window size
+     */
+    explicit PreviewScaler(cv::Size max_size);
+
+    /**
+     * @brief Build the resize plan for a frame size, if it changed
+     * @param frame_size Size of the full-resolution frames
+     * @return true if the plan was rebuilt, scaled camera matrices must be recomputed
+     */
+    bool plan(cv::Size frame_size);
+
+    /**
+     * @brief Downsample a frame to the preview size
+     * @param frame Full-resolution frame of the planned size
+     * @param preview Output preview, a copy of the frame if no scaling is needed, reused across calls
+     */
+    void apply(const cv::Mat& frame, cv::Mat& preview) const;
+
+    /**
+     * @brief Map a camera matrix to preview pixel coordinates, distortion coefficients are unchanged
+     * @param K 3x3 camera matrix of the full-resolution frame
+     * @return 3x3 camera matrix of the preview
+     */
+    cv::Mat scale_camera_matrix(const cv::Mat& K) const;
+
+    /**
+     * @brief Map full-resolution image points to preview pixel coordinates
+     * @param points Points in frame coordinates
+     * @param scaled Output points in preview coordinates
+     */
+    void scale_points(const std::vector<cv::Point2f>& points, std::vector<cv::Point2f>& scaled) const;
+
+    /**
+     * @brief Get the preview scale
+     * @return Preview pixels per frame pixel, at most 1
+     */
+    double get_scale() const;
+
+    /**
+     * @brief Get the preview size
+     * @return Size of the planned preview
+     */
+    cv::Size get_size() const;
+
+private:
+    cv::Size max_size_;
+    cv::Size frame_size_;       // Frame size of the current plan
+    cv::Size preview_size_;
+    double scale_ = 1.0;
+};
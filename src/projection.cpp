@@ -0,0 +1,216 @@
+#include "projection.hpp"
+
+#include <algorithm>
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+
+namespace Projection {
+
+/**
+ * @brief Project object points in single precision, four points per SIMD register
+ *
+ * Use OpenCV universal intrinsics, so the same code maps to SSE, NEON, or VSX. Points that do not fill
+ * a register go through the double-precision kernel
+ * @tparam M Distortion model, Pinhole or Standard
+ * @param cam Camera intrinsics
+ * @param pose Object to camera transform
+ * @param in Object points
+ * @param out Output pixel coordinates, same count as the input
+ * @param n Number of points
+ */
+template <Model M>
+static void project_points_simd(const Camera& cam, const Pose& pose, const cv::Point3f* in, cv::Point2f* out, size_t n) {
+    static_assert(M == Model::Pinhole || M == Model::Standard, "SIMD kernel supports pinhole and standard models only");
+    size_t i = 0;
+
+#if CV_SIMD128
+    auto splat = [](double v) { return cv::v_setall_f32((float)v); };
+    const cv::v_float32x4 r0 = splat(pose.R[0]), r1 = splat(pose.R[1]), r2 = splat(pose.R[2]);
+    const cv::v_float32x4 r3 = splat(pose.R[3]), r4 = splat(pose.R[4]), r5 = splat(pose.R[5]);
+    const cv::v_float32x4 r6 = splat(pose.R[6]), r7 = splat(pose.R[7]), r8 = splat(pose.R[8]);
+    const cv::v_float32x4 t0 = splat(pose.t[0]), t1 = splat(pose.t[1]), t2 = splat(pose.t[2]);
+    const cv::v_float32x4 fx = splat(cam.fx), fy = splat(cam.fy), cx = splat(cam.cx), cy = splat(cam.cy);
+    const cv::v_float32x4 k1 = splat(cam.k[0]), k2 = splat(cam.k[1]), p1 = splat(cam.k[2]), p2 = splat(cam.k[3]), k3 = splat(cam.k[4]);
+    const cv::v_float32x4 one = splat(1.0), two = splat(2.0);
+
+    for (; i + 4 <= n; i += 4) {
+        cv::v_float32x4 x, y, z;
+        cv::v_load_deinterleave((const float*)(in + i), x, y, z);
+
+        cv::v_float32x4 X = cv::v_muladd(r0, x, cv::v_muladd(r1, y, cv::v_muladd(r2, z, t0)));
+        cv::v_float32x4 Y = cv::v_muladd(r3, x, cv::v_muladd(r4, y, cv::v_muladd(r5, z, t1)));
+        cv::v_float32x4 Z = cv::v_muladd(r6, x, cv::v_muladd(r7, y, cv::v_muladd(r8, z, t2)));
+
+        cv::v_float32x4 iz = one / Z;
+        cv::v_float32x4 xn = X * iz;
+        cv::v_float32x4 yn = Y * iz;
+
+        if constexpr (M == Model::Standard) {
+            cv::v_float32x4 x2 = xn * xn, y2 = yn * yn, xy2 = two * xn * yn;
+            cv::v_float32x4 rr = x2 + y2;
+            cv::v_float32x4 radial = cv::v_muladd(rr, cv::v_muladd(rr, cv::v_muladd(rr, k3, k2), k1), one);
+            cv::v_float32x4 xd = xn * radial + p1 * xy2 + p2 * (rr + two * x2);
+            cv::v_float32x4 yd = yn * radial + p1 * (rr + two * y2) + p2 * xy2;
+            xn = xd;
+            yn = yd;
+        }
+
+        cv::v_store_interleave((float*)(out + i), cv::v_muladd(fx, xn, cx), cv::v_muladd(fy, yn, cy));
+    }
+#endif
+
+    if (i < n) {
+        project_points<M>(cam, pose, in + i, out + i, n - i);
+    }
+}
+
+/**
+ * @brief Convert a rotation and translation vector pair into a pose
+ * @param rvec Rotation vector, Rodrigues
+ * @param tvec Translation vector
+ * @return Pose with the rotation matrix expanded once
+ */
+Pose make_pose(const cv::Mat& rvec, const cv::Mat& tvec) {
+    Pose pose;
+
+    cv::Mat r, t, R;
+    rvec.convertTo(r, CV_64F);
+    tvec.convertTo(t, CV_64F);
+    cv::Rodrigues(r.reshape(1, 3), R);
+
+    for (int i = 0; i < 9; ++i) {
+        pose.R[i] = R.at<double>(i / 3, i % 3);
+    }
+    t = t.reshape(1, 3);
+    for (int i = 0; i < 3; ++i) {
+        pose.t[i] = t.at<double>(i);
+    }
+    return pose;
+}
+
+/**
+ * @brief Construct a Projector and select the kernel for the distortion model
+ *
+ * Trailing zero coefficients do not count, so a calibration saved with 8 coefficients and a zero rational
+ * part uses the standard kernel, and an all-zero vector uses the pinhole kernel. Thin prism and tilt
+ * coefficients fall back to cv::projectPoints
+ * @param K Camera intrinsic matrix
+ * @param dist Camera distortion coefficients, empty for none
+ */
+Projector::Projector(const cv::Mat& K, const cv::Mat& dist) {
+    cv::Mat K64;
+    K.convertTo(K64, CV_64F);
+    camera_.fx = K64.at<double>(0, 0);
+    camera_.fy = K64.at<double>(1, 1);
+    camera_.cx = K64.at<double>(0, 2);
+    camera_.cy = K64.at<double>(1, 2);
+
+    std::vector<double> coeffs;
+    if (!dist.empty()) {
+        cv::Mat d;
+        dist.convertTo(d, CV_64F);
+        coeffs.assign(d.begin<double>(), d.end<double>());
+    }
+
+    size_t used = coeffs.size();
+    while (used > 0 && coeffs[used - 1] == 0.0) {
+        --used;
+    }
+
+    if (used == 0) {
+        model_ = Model::Pinhole;
+        kernel_ = &project_points<Model::Pinhole>;
+        fast_kernel_ = &project_points_simd<Model::Pinhole>;
+    }
+    else if (used <= 5) {
+        model_ = Model::Standard;
+        kernel_ = &project_points<Model::Standard>;
+        fast_kernel_ = &project_points_simd<Model::Standard>;
+    }
+    else if (used <= 8) {
+        model_ = Model::Rational;
+        kernel_ = &project_points<Model::Rational>;
+        fast_kernel_ = kernel_;
+    }
+    else {
+        model_ = Model::Generic;
+        kernel_ = nullptr;
+        fast_kernel_ = nullptr;
+        K_ = K64;
+        dist_ = cv::Mat(coeffs, true);
+    }
+
+    for (size_t i = 0; i < std::min<size_t>(used, 8); ++i) {
+        camera_.k[i] = coeffs[i];
+    }
+}
+
+/**
+ * @brief Get the selected distortion model
+ * @return Distortion model
+ */
+Model Projector::get_model() const {
+    return model_;
+}
+
+/**
+ * @brief Project object points with a pose given as rotation and translation vectors
+ * @param pts Object points
+ * @param rvec Rotation vector, Rodrigues
+ * @param tvec Translation vector
+ * @param out Output pixel coordinates
+ */
+void Projector::project(const std::vector<cv::Point3f>& pts, const cv::Mat& rvec, const cv::Mat& tvec,
+                        std::vector<cv::Point2f>& out) const {
+    out.resize(pts.size());
+    if (pts.empty()) {
+        return;
+    }
+    project(pts.data(), pts.size(), make_pose(rvec, tvec), out.data());
+}
+
+/**
+ * @brief Project object points with an expanded pose
+ * @param pts Object points
+ * @param n Number of points
+ * @param pose Object to camera transform
+ * @param out Output pixel coordinates, room for n points
+ */
+void Projector::project(const cv::Point3f* pts, size_t n, const Pose& pose, cv::Point2f* out) const {
+    if (kernel_) {
+        kernel_(camera_, pose, pts, out, n);
+        return;
+    }
+
+    // Generic fallback for distortion models without a kernel
+    cv::Mat R(3, 3, CV_64F, const_cast<double*>(pose.R));
+    cv::Mat rvec, tvec(3, 1, CV_64F, const_cast<double*>(pose.t));
+    cv::Rodrigues(R, rvec);
+
+    std::vector<cv::Point3f> in(pts, pts + n);
+    std::vector<cv::Point2f> proj;
+    cv::projectPoints(in, rvec, tvec, K_, dist_, proj);
+    std::copy(proj.begin(), proj.end(), out);
+}
+
+/**
+ * @brief Project object points in single precision where a SIMD kernel exists
+ *
+ * Pinhole and standard models use the SIMD kernel, within a small fraction of a pixel of the
+ * double-precision result; other models fall back to project
+ * @param pts Object points
+ * @param n Number of points
+ * @param pose Object to camera transform
+ * @param out Output pixel coordinates, room for n points
+ */
+void Projector::project_fast(const cv::Point3f* pts, size_t n, const Pose& pose, cv::Point2f* out) const {
+    if (fast_kernel_) {
+        fast_kernel_(camera_, pose, pts, out, n);
+        return;
+    }
+    project(pts, n, pose, out);
+}
+
+} // namespace Projection
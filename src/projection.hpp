@@ -0,0 +1,160 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+
+/**
+ * @brief Namespace containing point projection kernels specialized per distortion model
+ *
+ * cv::projectPoints handles every distortion model at run time and computes Jacobians on request.
+ * The kernels here are templated on the model, so the model is chosen once per camera and the
+ * per-point loop has no branching on the coefficient count
+ */
+namespace Projection {
+    /**
+     * @brief Distortion models with a specialized kernel
+     */
+    enum class Model {
+        Pinhole,    // No distortion
+        Standard,   // k1, k2, p1, p2, k3
+        Rational,   // k1, k2, p1, p2, k3, k4, k5, k6
+        Generic     // Anything else, handled by cv::projectPoints
+    };
+
+    /**
+     * @brief Camera intrinsics in a flat layout for the kernels
+     */
+    struct Camera {
+        double fx = 1.0, fy = 1.0, cx = 0.0, cy = 0.0;
+        double k[8] = {};   // k1, k2, p1, p2, k3, k4, k5, k6
+    };
+
+    /**
+     * @brief Rigid transform from object to camera coordinates, rotation matrix row-major
+     */
+    struct Pose {
+        double R[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+        double t[3] = {};
+    };
+
+    /**
+     * @brief Convert a rotation and translation vector pair into a pose
+     * @param rvec Rotation vector, Rodrigues
+     * @param tvec Translation vector
+     * @return Pose with the rotation matrix expanded once
+     */
+    Pose make_pose(const cv::Mat& rvec, const cv::Mat& tvec);
+
+    /**
+     * @brief Project one point in camera coordinates to pixel coordinates
+     * @tparam M Distortion model, anything but Generic
+     * @param cam Camera intrinsics
+     * @param X, Y, Z Point in camera coordinates
+     * @return Pixel coordinates
+     */
+    template <Model M>
+    inline cv::Point2d project_camera_point(const Camera& cam, double X, double Y, double Z) {
+        double x = X / Z;
+        double y = Y / Z;
+
+        if constexpr (M == Model::Pinhole) {
+            return { cam.fx * x + cam.cx, cam.fy * y + cam.cy };
+        }
+        else {
+            double r2 = x * x + y * y;
+            double radial = 1.0 + r2 * (cam.k[0] + r2 * (cam.k[1] + r2 * cam.k[4]));
+            if constexpr (M == Model::Rational) {
+                radial /= 1.0 + r2 * (cam.k[5] + r2 * (cam.k[6] + r2 * cam.k[7]));
+            }
+            double xy2 = 2.0 * x * y;
+            double xd = x * radial + cam.k[2] * xy2 + cam.k[3] * (r2 + 2.0 * x * x);
+            double yd = y * radial + cam.k[2] * (r2 + 2.0 * y * y) + cam.k[3] * xy2;
+            return { cam.fx * xd + cam.cx, cam.fy * yd + cam.cy };
+        }
+    }
+
+    /**
+     * @brief Project object points to pixel coordinates
+     * @tparam M Distortion model, anything but Generic
+     * @param cam Camera intrinsics
+     * @param pose Object to camera transform
+     * @param in Object points
+     * @param out Output pixel coordinates, same count as the input
+     * @param n Number of points
+     */
+    template <Model M>
+    void project_points(const Camera& cam, const Pose& pose, const cv::Point3f* in, cv::Point2f* out, size_t n) {
+        const double* R = pose.R;
+        const double* t = pose.t;
+        for (size_t i = 0; i < n; ++i) {
+            double X = R[0] * in[i].x + R[1] * in[i].y + R[2] * in[i].z + t[0];
+            double Y = R[3] * in[i].x + R[4] * in[i].y + R[5] * in[i].z + t[1];
+            double Z = R[6] * in[i].x + R[7] * in[i].y + R[8] * in[i].z + t[2];
+            cv::Point2d p = project_camera_point<M>(cam, X, Y, Z);
+            out[i] = cv::Point2f((float)p.x, (float)p.y);
+        }
+    }
+
+    /**
+     * @class Projector
+     * @brief Project points with the kernel of one camera, chosen once at construction
+     */
+    class Projector {
+    public:
+        Projector() = default;
+
+        /**
+         * @brief Construct a Projector and select the kernel for the distortion model
+         * @param K Camera intrinsic matrix
+         * @param dist Camera distortion coefficients, empty for none
+         */
+        Projector(const cv::Mat& K, const cv::Mat& dist);
+
+        /**
+         * @brief Get the selected distortion model
+         * @return Distortion model
+         */
+        Model get_model() const;
+
+        /**
+         * @brief Project object points with a pose given as rotation and translation vectors
+         * @param pts Object points
+         * @param rvec Rotation vector, Rodrigues
+         * @param tvec Translation vector
+         * @param out Output pixel coordinates
+         */
+        void project(const std::vector<cv::Point3f>& pts, const cv::Mat& rvec, const cv::Mat& tvec,
+                     std::vector<cv::Point2f>& out) const;
+
+        /**
+         * @brief Project object points with an expanded pose
+         * @param pts Object points
+         * @param n Number of points
+         * @param pose Object to camera transform
+         * @param out Output pixel coordinates, room for n points
+         */
+        void project(const cv::Point3f* pts, size_t n, const Pose& pose, cv::Point2f* out) const;
+
+        /**
+         * @brief Project object points in single precision where a SIMD kernel exists, for overlays
+         * @param pts Object points
+         * @param n Number of points
+         * @param pose Object to camera transform
+         * @param out Output pixel coordinates, room for n points
+         */
+        void project_fast(const cv::Point3f* pts, size_t n, const Pose& pose, cv::Point2f* out) const;
+
+    private:
+        using Kernel = void (*)(const Camera&, const Pose&, const cv::Point3f*, cv::Point2f*, size_t);
+
+        Camera camera_;
+        Model model_ = Model::Pinhole;
+        Kernel kernel_ = &project_points<Model::Pinhole>;
+        Kernel fast_kernel_ = &project_points<Model::Pinhole>;   // Single-precision SIMD kernel, if any
+
+        cv::Mat K_;       // Kept for the Generic fallback
+        cv::Mat dist_;
+    };
+}
@@ -1,125 +1,86 @@
 #include "renderer.hpp"
 
-#include <string>
-#include <vector>
-
-
-constexpr const float CUBE_SCALE = 1.0f;
+#include "glyph_atlas.hpp"
+#include "overlay_scene.hpp"
 
 
 namespace Renderer {
 
 /**
- * @brief Draw 3D axes, X green, Y red, Z blue, on the image using the given camera pose and offset
+ * @brief Draw the calibrated board overlay: axes, labels, cubes at E1 and E8, and the board origin
  * @param image Image on which to draw
- * @param K Camera intrinsic matrix
- * @param dist Camera distortion coefficients
+ * @param rows Number of chessboard rows
+ * @param cols Number of chessboard columns
+ * @param square_size Size of each chessboard square
+ * @param projector Projection kernel of the camera
  * @param rvec Rotation vector, Rodrigues
  * @param tvec Translation vector
- * @param offset 3D offset for the axes origin
  *
- * Project the axes from 3D to 2D using the camera parameters and draw in color
+ * Build the board scene and render it with a single projection; callers that draw many frames should
+ * build the scene once with OverlayScene::chessboard and render it per pose
  */
-void draw_axes(cv::Mat& image, const cv::Mat& K, const cv::Mat& dist, const cv::Mat& rvec, const cv::Mat& tvec, cv::Point3f offset) {
-    // Define the endpoints of the axes in 3D (relative to offset)
-    std::vector<cv::Point3f> axes = {
-        {0.0f, 0.0f, 0.0f}, // origin
-        {0.0f, 4.0f, 0.0f}, // Y axis
-        {4.0f, 0.0f, 0.0f}, // X axis
-        {0.0f, 0.0f,-4.0f}  // Z axis (negative for OpenCV)
-    };
-
-    // Apply offset to all points
-    for (auto& a : axes) { 
-        a += offset;
-    }
-
-    // Project 3D points to 2D image
-    std::vector<cv::Point2f> proj;
-    cv::projectPoints(axes, rvec, tvec, K, dist, proj);
-
-    // Draw the axes lines
-    cv::line(image, proj[0], proj[1], cv::Scalar(0,0,255), 2);  // Y: red
-    cv::line(image, proj[0], proj[2], cv::Scalar(0,255,0), 2);  // X: green
-    cv::line(image, proj[0], proj[3], cv::Scalar(255,0,0), 2);  // Z: blue
+void draw_board(cv::Mat& image, int rows, int cols, float square_size, 
+                const Projection::Projector& projector, 
+                const cv::Mat& rvec, const cv::Mat& tvec)
+{
+    OverlayScene::chessboard(rows, cols, square_size).render(image, projector, rvec, tvec);
 }
 
 /**
- * @brief Draw a 3D cube in the scene projected onto the image
- * @param image Image on which to draw
- * @param K Camera intrinsic matrix
- * @param dist Camera distortion coefficients
- * @param rvec Rotation vector, Rodrigues
- * @param tvec Translation vector
- * @param base 3D base corner of the cube
- * @param color Color of the cube edges, default white
+ * @brief Draw text with the cached glyph atlas of its scale and thickness, placed like cv::putText
+ * @param image 8-bit BGR or BGRA image on which to draw
+ * @param text Text to draw
+ * @param origin Bottom-left corner of the text
+ * @param scale Font scale
+ * @param color Text color
+ * @param thickness Stroke thickness, default 2
+ * @return Region covered by the text
  *
- * Define the cube by 8 corners and project to 2D for rendering
+ * Glyphs are rasterized once per scale and thickness, later calls only blend them
  */
-void draw_cube(cv::Mat& image, const cv::Mat& K, const cv::Mat& dist, 
-               const cv::Mat& rvec, const cv::Mat& tvec, 
-               cv::Point3f base, cv::Scalar color)
+cv::Rect draw_text(cv::Mat& image, const std::string& text, cv::Point origin, double scale,
+                   cv::Scalar color, int thickness)
 {
-    // Define the 8 corners of the cube in 3D
-    std::vector<cv::Point3f> cube_pts = {
-        {base.x, base.y, base.z},
-        {base.x, base.y+CUBE_SCALE, base.z},
-        {base.x+CUBE_SCALE, base.y, base.z},
-        {base.x, base.y, base.z-CUBE_SCALE},
-        {base.x+CUBE_SCALE, base.y+CUBE_SCALE, base.z},
-        {base.x, base.y+CUBE_SCALE, base.z-CUBE_SCALE},
-        {base.x+CUBE_SCALE, base.y, base.z-CUBE_SCALE},
-        {base.x+CUBE_SCALE, base.y+CUBE_SCALE, base.z-CUBE_SCALE}
-    };
-
-    // Project 3D cube corners to 2D image
-    std::vector<cv::Point2f> proj;
-    cv::projectPoints(cube_pts, rvec, tvec, K, dist, proj);
-
-    // Lambda to draw a line between two projected points
-    auto draw = [&](int i, int j) {
-        cv::line(image, proj[i], proj[j], color, 2);
-    };
-
-    // Draw cube edges (bottom, top, sides, verticals)
-    draw(0,1); draw(1,4); draw(4,2); draw(2,0); // bottom face
-    draw(3,5); draw(5,7); draw(7,6); draw(6,3); // top face
-    draw(0,3); draw(1,5); draw(2,6); draw(4,7); // verticals
+    const GlyphAtlas& atlas = GlyphAtlas::get(scale, thickness);
+    atlas.draw(image, text, origin, color);
+    return atlas.get_bounds(text, origin);
 }
 
 /**
- * @brief Draw chessboard row and column labels, A-H and 1-8, on the image using 3D projection
- * @param image Image on which to draw
- * @param rows Number of chessboard rows
- * @param cols Number of chessboard columns
- * @param square_size Size of each chessboard square
- * @param K Camera intrinsic matrix
- * @param dist Camera distortion coefficients
- * @param rvec Rotation vector, Rodrigues
- * @param tvec Translation vector
- * @param offset 3D offset for the label origin
+ * @brief Draw detected chessboard corners, one color per row, connected in detection order
+ * @param image 8-bit BGR or BGRA image on which to draw, BGRA pixels are drawn opaque
+ * @param pattern_size Number of inner corners per row and column
+ * @param corners Detected corners
+ * @return Region covered by the drawing
  *
- * Project 3D label positions to 2D and draw text labels for rows and columns
+ * Follow the look of cv::drawChessboardCorners, which leaves the alpha of BGRA images untouched
  */
-void draw_labels(cv::Mat& image, int rows, int cols, float square_size, 
-                 const cv::Mat& K, const cv::Mat& dist, 
-                 const cv::Mat& rvec, const cv::Mat& tvec, cv::Point3f offset)
-{
-    // Draw row labels (A, B, ...)
-    for (int y = 0; y <= rows; ++y) {
-        std::vector<cv::Point2f> pt2d;
-        std::vector<cv::Point3f> pt3d = { offset + cv::Point3f(-0.5f * square_size, (y + 0.5f) * square_size, 0) };
-        cv::projectPoints(pt3d, rvec, tvec, K, dist, pt2d);
-        cv::putText(image, std::string(1, ('A' + y)), pt2d[0], cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0,0,0), 2, cv::LINE_AA);
+cv::Rect draw_corners(cv::Mat& image, cv::Size pattern_size, const std::vector<cv::Point2f>& corners) {
+    static const cv::Scalar row_colors[] = {
+        {0,0,255,255}, {0,128,255,255}, {0,200,200,255}, {0,255,0,255},
+        {200,200,0,255}, {255,0,0,255}, {255,0,255,255}
+    };
+    const int radius = 4;
+    if (corners.empty() || pattern_size.width <= 0) {
+        return cv::Rect();
     }
 
-    // Draw column labels (1, 2, ...)
-    for (int x = 0; x <= cols; ++x) {
-        std::vector<cv::Point2f> pt2d;
-        std::vector<cv::Point3f> pt3d = { offset + cv::Point3f((x + 0.5f) * square_size, -0.5f * square_size, 0) };
-        cv::projectPoints(pt3d, rvec, tvec, K, dist, pt2d);
-        cv::putText(image, std::to_string(x+1), pt2d[0], cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0,0,0), 2, cv::LINE_AA);
+    cv::Point prev;
+    for (size_t i = 0; i < corners.size(); ++i) {
+        const cv::Scalar& color = row_colors[(i / pattern_size.width) % 7];
+        cv::Point pt(cvRound(corners[i].x), cvRound(corners[i].y));
+
+        cv::line(image, pt - cv::Point(radius, radius), pt + cv::Point(radius, radius), color, 1, cv::LINE_AA);
+        cv::line(image, pt - cv::Point(radius, -radius), pt + cv::Point(radius, -radius), color, 1, cv::LINE_AA);
+        cv::circle(image, pt, radius + 1, color, 1, cv::LINE_AA);
+        if (i > 0) {
+            cv::line(image, prev, pt, color, 1, cv::LINE_AA);
+        }
+        prev = pt;
     }
+
+    cv::Rect bounds = cv::boundingRect(corners);
+    return cv::Rect(bounds.x - radius - 2, bounds.y - radius - 2, bounds.width + 2 * radius + 4, bounds.height + 2 * radius + 4);
 }
 
 } // namespace Renderer
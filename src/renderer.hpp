@@ -1,52 +1,51 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include <opencv2/opencv.hpp>
 
+#include "projection.hpp"
+
 /**
  * @brief Namespace containing functions for rendering 3D objects and labels on images
  *
- * Provide utilities to draw axes, cubes, and chessboard labels using camera calibration and pose
+ * Provide utilities to draw the board overlay with the projection kernel of the camera and the pose, text, and detected corners
  */
 namespace Renderer {
     /**
-     * @brief Draw 3D axes, X green, Y red, Z blue, on the image using the given camera pose and offset
+     * @brief Draw the calibrated board overlay: axes, labels, cubes at E1 and E8, and the board origin
      * @param image Image on which to draw
-     * @param K Camera intrinsic matrix
-     * @param dist Camera distortion coefficients
+     * @param rows Number of chessboard rows
+     * @param cols Number of chessboard columns
+     * @param square_size Size of each chessboard square
+     * @param projector Projection kernel of the camera
      * @param rvec Rotation vector, Rodrigues
      * @param tvec Translation vector
-     * @param offset 3D offset for the axes origin
      */
-    void draw_axes(cv::Mat& image, const cv::Mat& K, const cv::Mat& dist, 
-                   const cv::Mat& rvec, const cv::Mat& tvec, cv::Point3f offset);
-    
+    void draw_board(cv::Mat& image, int rows, int cols, float square_size, 
+                    const Projection::Projector& projector, 
+                    const cv::Mat& rvec, const cv::Mat& tvec);
+
     /**
-     * @brief Draw a 3D cube in the scene projected onto the image
-     * @param image Image on which to draw
-     * @param K Camera intrinsic matrix
-     * @param dist Camera distortion coefficients
-     * @param rvec Rotation vector, Rodrigues
-     * @param tvec Translation vector
-     * @param base 3D base corner of the cube
-     * @param color Color of the cube edges, default white
+     * @brief Draw text with the cached glyph atlas of its scale and thickness, placed like cv::putText
+     * @param image 8-bit BGR or BGRA image on which to draw
+     * @param text Text to draw
+     * @param origin Bottom-left corner of the text
+     * @param scale Font scale
+     * @param color Text color
+     * @param thickness Stroke thickness, default 2
+     * @return Region covered by the text
      */
-    void draw_cube(cv::Mat& image, const cv::Mat& K, const cv::Mat& dist, 
-                   const cv::Mat& rvec, const cv::Mat& tvec, 
-                   cv::Point3f base, cv::Scalar color = cv::Scalar(255,255,255));
+    cv::Rect draw_text(cv::Mat& image, const std::string& text, cv::Point origin, double scale,
+                       cv::Scalar color, int thickness = 2);
 
     /**
-     * @brief Draw chessboard row and column labels, A-H and 1-8, on the image using 3D projection
-     * @param image Image on which to draw
-     * @param rows Number of chessboard rows
-     * @param cols Number of chessboard columns
-     * @param square_size Size of each chessboard square
-     * @param K Camera intrinsic matrix
-     * @param dist Camera distortion coefficients
-     * @param rvec Rotation vector, Rodrigues
-     * @param tvec Translation vector
-     * @param offset 3D offset for the label origin
+     * @brief Draw detected chessboard corners, one color per row, connected in detection order
+     * @param image 8-bit BGR or BGRA image on which to draw, BGRA pixels are drawn opaque
+     * @param pattern_size Number of inner corners per row and column
+     * @param corners Detected corners
+     * @return Region covered by the drawing
      */
-    void draw_labels(cv::Mat& image, int rows, int cols, float square_size, 
-                     const cv::Mat& K, const cv::Mat& dist, 
-                     const cv::Mat& rvec, const cv::Mat& tvec, cv::Point3f offset);
+    cv::Rect draw_corners(cv::Mat& image, cv::Size pattern_size, const std::vector<cv::Point2f>& corners);
 }
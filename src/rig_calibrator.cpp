@@ -0,0 +1,556 @@
+#include "rig_calibrator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core.hpp>
+
+#include "chessboard.hpp"
+
+
+constexpr int MAX_LM_ITERATIONS = 50;       // Levenberg-Marquardt iterations of the joint extrinsics refinement
+constexpr double MAX_LM_DAMPING = 1e8;      // Give up on a step once the damping grows beyond this
+constexpr double MIN_REL_IMPROVEMENT = 1e-9; // Stop when the error improves by less than this fraction
+
+
+/**
+ * @brief Invert a rigid transform given as rotation and translation vectors
+ * @param rvec Rotation vector, Rodrigues
+ * @param tvec Translation vector
+ * @param rvec_inv Output rotation vector of the inverse
+ * @param tvec_inv Output translation vector of the inverse
+ */
+static void invert_pose(const cv::Vec3d& rvec, const cv::Vec3d& tvec, cv::Vec3d& rvec_inv, cv::Vec3d& tvec_inv) {
+    cv::Matx33d R;
+    cv::Rodrigues(rvec, R);
+    cv::Rodrigues(R.t(), rvec_inv);
+    tvec_inv = -(R.t() * tvec);
+}
+
+/**
+ * @brief Compose two rigid transforms, apply the first then the second
+ * @param rvec1 Rotation vector of the first transform
+ * @param tvec1 Translation vector of the first transform
+ * @param rvec2 Rotation vector of the second transform
+ * @param tvec2 Translation vector of the second transform
+ * @param rvec3 Output rotation vector of the composition
+ * @param tvec3 Output translation vector of the composition
+ */
+static void compose_pose(const cv::Vec3d& rvec1, const cv::Vec3d& tvec1, const cv::Vec3d& rvec2, const cv::Vec3d& tvec2,
+                         cv::Vec3d& rvec3, cv::Vec3d& tvec3)
+{
+    cv::composeRT(rvec1, tvec1, rvec2, tvec2, rvec3, tvec3);
+}
+
+/**
+ * @brief Measure how far apart two rigid transforms are
+ * @return Rotation angle between them plus their translation distance relative to the longer translation,
+ *         symmetric so that the medoid does not favor long translations
+ */
+static double pose_distance(const cv::Vec3d& rvec1, const cv::Vec3d& tvec1, const cv::Vec3d& rvec2, const cv::Vec3d& tvec2) {
+    cv::Matx33d R1, R2;
+    cv::Rodrigues(rvec1, R1);
+    cv::Rodrigues(rvec2, R2);
+    cv::Vec3d r_diff;
+    cv::Rodrigues(R1.t() * R2, r_diff);
+    return cv::norm(r_diff) + cv::norm(tvec1 - tvec2) / (std::max(cv::norm(tvec1), cv::norm(tvec2)) + 1e-9);
+}
+
+/**
+ * @brief Construct a new RigCalibrator object
+ * @param num_cameras Number of cameras in the rig
+ * @param object_pts 3D object points of the chessboard model, shared by all observations
+ */
+RigCalibrator::RigCalibrator(size_t num_cameras, const std::vector<cv::Point3f>& object_pts)
+    : object_pts_(object_pts), cameras_(num_cameras) {}
+
+/**
+ * @brief Add the detection of one camera in one synchronized frame
+ *
+ * The detection is also a calibration sample for the intrinsics of that camera
+ * @param frame Index of the synchronized frame
+ * @param camera Index of the camera
+ * @param image_pts 2D image points, A1 order
+ */
+void RigCalibrator::add_observation(int frame, size_t camera, const std::vector<cv::Point2f>& image_pts) {
+    cameras_[camera].add_sample(image_pts, object_pts_);
+    observations_.push_back({frame, camera, image_pts, cv::Vec3d(), cv::Vec3d()});
+}
+
+/**
+ * @brief Run the intrinsics and the joint extrinsics calibration
+ *
+ * Calibrate every camera in parallel from all its views, estimate the board pose of every view of a
+ * frame seen by two or more cameras, chain those views into initial camera-to-rig poses, and refine
+ * all poses jointly
+ * @param image_sizes Image size of every camera
+ * @return true if every camera is calibrated and connected to the rig, false otherwise
+ */
+bool RigCalibrator::calibrate(const std::vector<cv::Size>& image_sizes) {
+    size_t num_cameras = cameras_.size();
+    if (image_sizes.size() != num_cameras || observations_.empty()) {
+        return false;
+    }
+    image_sizes_ = image_sizes;
+
+    // Intrinsics of all cameras concurrently
+    std::vector<int> calibrated(num_cameras, 0);
+    cv::parallel_for_(cv::Range(0, (int)num_cameras), [&](const cv::Range& range) {
+        for (int c = range.start; c < range.end; ++c) {
+            calibrated[c] = cameras_[c].calibrate(image_sizes[c]) ? 1 : 0;
+        }
+    });
+    if (std::find(calibrated.begin(), calibrated.end(), 0) != calibrated.end()) {
+        return false; // A camera without detections
+    }
+
+    // Views of frames seen by one camera only serve the intrinsics, the extrinsics need frames linking cameras
+    std::map<int, int> views_per_frame;
+    for (const auto& obs : observations_) {
+        ++views_per_frame[obs.frame];
+    }
+    linked_.clear();
+    for (const auto& obs : observations_) {
+        if (views_per_frame[obs.frame] >= 2) {
+            linked_.push_back(obs);
+        }
+    }
+
+    // Board pose in every linked view with the calibrated intrinsics
+    cv::parallel_for_(cv::Range(0, (int)linked_.size()), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            Observation& obs = linked_[i];
+            const Calibrator& camera = cameras_[obs.camera];
+            cv::solvePnP(object_pts_, obs.image_pts, camera.get_camera_matrix(), camera.get_dist_coeffs(), obs.rvec, obs.tvec);
+        }
+    });
+
+    if (!initialize_extrinsics()) {
+        return false; // A camera never shares a frame with the rest of the rig
+    }
+    refine_extrinsics(MAX_LM_ITERATIONS);
+
+    size_t num_points = 0;
+    double sq_error = total_error(num_points);
+    reproj_error_ = num_points > 0 ? std::sqrt(sq_error / num_points) : 0.0;
+    return true;
+}
+
+/**
+ * @brief Chain the per-view board poses into an initial camera-to-rig estimate
+ *
+ * Every frame seen by two cameras gives an estimate of their relative pose. The board looks the same
+ * after a half turn, so each camera picks one of two equally good A1 orderings on its own, and every
+ * frame contributes its estimate with one view as detected and with that view turned; the turned
+ * estimates scatter as the board moves while the true ones agree. Starting from camera 0, repeatedly
+ * attach the camera with the most shared frames to an attached camera, using the medoid of the
+ * relative pose estimates. Each frame then gets its board pose from its first view, and its other
+ * views are turned where needed to share that view's board ordering
+ * @return true if every camera is connected to camera 0 by shared frames
+ */
+bool RigCalibrator::initialize_extrinsics() {
+    size_t num_cameras = cameras_.size();
+    int num_frames = 0;
+    for (const auto& obs : linked_) {
+        num_frames = std::max(num_frames, obs.frame + 1);
+    }
+
+    std::vector<std::vector<size_t>> by_frame(num_frames);
+    for (size_t i = 0; i < linked_.size(); ++i) {
+        by_frame[linked_[i].frame].push_back(i);
+    }
+
+    // Relative pose estimates, camera b to camera a coordinates, for every ordered camera pair
+    struct Estimate { cv::Vec3d rvec, tvec; };
+    std::vector<std::vector<Estimate>> relative(num_cameras * num_cameras);
+    for (const auto& views : by_frame) {
+        for (size_t i : views) {
+            for (size_t j : views) {
+                const Observation& a = linked_[i];
+                const Observation& b = linked_[j];
+                if (a.camera == b.camera) {
+                    continue;
+                }
+                cv::Vec3d rvec_inv, tvec_inv, rvec, tvec;
+                invert_pose(b.rvec, b.tvec, rvec_inv, tvec_inv);
+                compose_pose(rvec_inv, tvec_inv, a.rvec, a.tvec, rvec, tvec);
+                relative[a.camera * num_cameras + b.camera].push_back({rvec, tvec});
+
+                // The same estimate with view b in the other board ordering
+                std::vector<cv::Point2f> turned_pts = b.image_pts;
+                cv::Vec3d turned_rvec = b.rvec, turned_tvec = b.tvec;
+                Chessboard::half_turn(turned_pts, object_pts_, turned_rvec, turned_tvec);
+                invert_pose(turned_rvec, turned_tvec, rvec_inv, tvec_inv);
+                compose_pose(rvec_inv, tvec_inv, a.rvec, a.tvec, rvec, tvec);
+                relative[a.camera * num_cameras + b.camera].push_back({rvec, tvec});
+            }
+        }
+    }
+
+    camera_rvecs_.assign(num_cameras, cv::Vec3d());
+    camera_tvecs_.assign(num_cameras, cv::Vec3d());
+    std::vector<bool> attached(num_cameras, false);
+    attached[0] = true;
+
+    for (size_t step = 1; step < num_cameras; ++step) {
+        // Unattached camera with the most frames shared with an attached camera
+        size_t best_from = 0, best_to = 0, best_count = 0;
+        for (size_t from = 0; from < num_cameras; ++from) {
+            for (size_t to = 0; to < num_cameras; ++to) {
+                size_t count = relative[to * num_cameras + from].size();
+                if (attached[from] && !attached[to] && count > best_count) {
+                    best_from = from;
+                    best_to = to;
+                    best_count = count;
+                }
+            }
+        }
+        if (best_count == 0) {
+            return false;
+        }
+
+        // Medoid of the relative pose estimates, robust against single bad views
+        const auto& estimates = relative[best_to * num_cameras + best_from];
+        size_t medoid = 0;
+        double best_sum = 1e300;
+        for (size_t i = 0; i < estimates.size(); ++i) {
+            double sum = 0.0;
+            for (size_t j = 0; j < estimates.size(); ++j) {
+                sum += pose_distance(estimates[i].rvec, estimates[i].tvec, estimates[j].rvec, estimates[j].tvec);
+            }
+            if (sum < best_sum) {
+                best_sum = sum;
+                medoid = i;
+            }
+        }
+
+        // Rig to camera: rig to the attached camera, then to the new camera
+        compose_pose(camera_rvecs_[best_from], camera_tvecs_[best_from], estimates[medoid].rvec, estimates[medoid].tvec,
+                     camera_rvecs_[best_to], camera_tvecs_[best_to]);
+        attached[best_to] = true;
+    }
+
+    // Board to rig for every frame, from its first view, and every other view of the frame turned to the
+    // board ordering of the first one where the turned view agrees better with the camera's extrinsics
+    board_rvecs_.assign(num_frames, cv::Vec3d());
+    board_tvecs_.assign(num_frames, cv::Vec3d());
+    board_valid_.assign(num_frames, false);
+    for (int f = 0; f < num_frames; ++f) {
+        if (by_frame[f].empty()) {
+            continue;
+        }
+        const Observation& obs = linked_[by_frame[f].front()];
+        cv::Vec3d rvec_inv, tvec_inv;
+        invert_pose(camera_rvecs_[obs.camera], camera_tvecs_[obs.camera], rvec_inv, tvec_inv);
+        compose_pose(obs.rvec, obs.tvec, rvec_inv, tvec_inv, board_rvecs_[f], board_tvecs_[f]);
+        board_valid_[f] = true;
+
+        for (size_t k = 1; k < by_frame[f].size(); ++k) {
+            Observation& view = linked_[by_frame[f][k]];
+            cv::Vec3d predicted_rvec, predicted_tvec;
+            compose_pose(board_rvecs_[f], board_tvecs_[f], camera_rvecs_[view.camera], camera_tvecs_[view.camera],
+                         predicted_rvec, predicted_tvec);
+
+            std::vector<cv::Point2f> turned_pts = view.image_pts;
+            cv::Vec3d turned_rvec = view.rvec, turned_tvec = view.tvec;
+            Chessboard::half_turn(turned_pts, object_pts_, turned_rvec, turned_tvec);
+            if (pose_distance(predicted_rvec, predicted_tvec, turned_rvec, turned_tvec) <
+                pose_distance(predicted_rvec, predicted_tvec, view.rvec, view.tvec)) {
+                view.image_pts = std::move(turned_pts);
+                view.rvec = turned_rvec;
+                view.tvec = turned_tvec;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Refine all board poses and camera extrinsics jointly
+ *
+ * One Levenberg-Marquardt solve over every camera-to-rig pose except camera 0, which defines the rig,
+ * and every board pose. Each observation couples one board pose with one camera, so the normal
+ * equations are sparse: the board blocks are eliminated per frame with the Schur complement, the
+ * reduced camera system is solved, and the board updates are recovered per frame. Frames are
+ * linearized in parallel
+ * @param max_iterations Maximum number of Levenberg-Marquardt iterations
+ */
+void RigCalibrator::refine_extrinsics(int max_iterations) {
+    const int num_cameras = (int)cameras_.size();
+    const int num_frames = (int)board_valid_.size();
+    const int m = 6 * (num_cameras - 1);    // Camera unknowns, camera 0 is fixed
+
+    std::vector<std::vector<size_t>> by_frame(num_frames);
+    for (size_t i = 0; i < linked_.size(); ++i) {
+        by_frame[linked_[i].frame].push_back(i);
+    }
+
+    // Linearized normal equations of one frame: its board block, and per camera its coupling to the board
+    struct FrameBlock {
+        cv::Mat V = cv::Mat::zeros(6, 6, CV_64F);   // Board normal block
+        cv::Mat g = cv::Mat::zeros(6, 1, CV_64F);   // Board gradient
+        std::vector<int> cameras;                   // Cameras other than 0 seeing the frame
+        std::vector<cv::Mat> W;                     // Board-camera coupling, Jb^T Jc, per camera
+        std::vector<cv::Mat> U;                     // Camera normal contribution, Jc^T Jc, per camera
+        std::vector<cv::Mat> gc;                    // Camera gradient contribution, Jc^T r, per camera
+    };
+
+    // Residuals of one observation and their derivatives by the board pose (first transform of the
+    // chain) and by the camera extrinsic (second transform)
+    auto linearize = [this](const Observation& obs, cv::Mat& residual, cv::Mat& Jb, cv::Mat& Jc) {
+        cv::Mat r3, t3, dr3dr1, dr3dt1, dr3dr2, dr3dt2, dt3dr1, dt3dt1, dt3dr2, dt3dt2;
+        cv::composeRT(board_rvecs_[obs.frame], board_tvecs_[obs.frame], camera_rvecs_[obs.camera], camera_tvecs_[obs.camera],
+                      r3, t3, dr3dr1, dr3dt1, dr3dr2, dr3dt2, dt3dr1, dt3dt1, dt3dr2, dt3dt2);
+
+        const Calibrator& camera = cameras_[obs.camera];
+        std::vector<cv::Point2f> proj;
+        cv::Mat J;
+        cv::projectPoints(object_pts_, r3, t3, camera.get_camera_matrix(), camera.get_dist_coeffs(), proj, J);
+
+        residual.create((int)proj.size() * 2, 1, CV_64F);
+        for (size_t k = 0; k < proj.size(); ++k) {
+            residual.at<double>((int)k * 2) = proj[k].x - obs.image_pts[k].x;
+            residual.at<double>((int)k * 2 + 1) = proj[k].y - obs.image_pts[k].y;
+        }
+
+        // Chain rule through the composition, d(r3, t3) / d(parameters)
+        cv::Mat Db(6, 6, CV_64F), Dc(6, 6, CV_64F);
+        dr3dr1.copyTo(Db(cv::Rect(0, 0, 3, 3)));
+        dr3dt1.copyTo(Db(cv::Rect(3, 0, 3, 3)));
+        dt3dr1.copyTo(Db(cv::Rect(0, 3, 3, 3)));
+        dt3dt1.copyTo(Db(cv::Rect(3, 3, 3, 3)));
+        dr3dr2.copyTo(Dc(cv::Rect(0, 0, 3, 3)));
+        dr3dt2.copyTo(Dc(cv::Rect(3, 0, 3, 3)));
+        dt3dr2.copyTo(Dc(cv::Rect(0, 3, 3, 3)));
+        dt3dt2.copyTo(Dc(cv::Rect(3, 3, 3, 3)));
+
+        cv::Mat Jp = J.colRange(0, 6);
+        Jb = Jp * Db;
+        Jc = Jp * Dc;
+    };
+
+    // Marquardt damping of the diagonal of a normal block
+    auto damp = [](const cv::Mat& A, double lambda) {
+        cv::Mat D = A.clone();
+        for (int i = 0; i < D.rows; ++i) {
+            D.at<double>(i, i) = D.at<double>(i, i) * (1.0 + lambda) + 1e-12;
+        }
+        return D;
+    };
+
+    size_t num_points = 0;
+    double error = total_error(num_points);
+    double lambda = 1e-3;
+
+    for (int iter = 0; iter < max_iterations; ++iter) {
+        // Linearize every frame at the current poses
+        std::vector<FrameBlock> blocks(num_frames);
+        cv::parallel_for_(cv::Range(0, num_frames), [&](const cv::Range& range) {
+            for (int f = range.start; f < range.end; ++f) {
+                FrameBlock& block = blocks[f];
+                for (size_t i : by_frame[f]) {
+                    const Observation& obs = linked_[i];
+                    cv::Mat residual, Jb, Jc;
+                    linearize(obs, residual, Jb, Jc);
+                    block.V += Jb.t() * Jb;
+                    block.g += Jb.t() * residual;
+                    if (obs.camera > 0) {
+                        block.cameras.push_back((int)obs.camera);
+                        block.W.push_back(Jb.t() * Jc);
+                        block.U.push_back(Jc.t() * Jc);
+                        block.gc.push_back(Jc.t() * residual);
+                    }
+                }
+            }
+        });
+
+        cv::Mat U = cv::Mat::zeros(m, m, CV_64F);
+        cv::Mat gc = cv::Mat::zeros(m, 1, CV_64F);
+        for (const auto& block : blocks) {
+            for (size_t k = 0; k < block.cameras.size(); ++k) {
+                int c = 6 * (block.cameras[k] - 1);
+                U(cv::Rect(c, c, 6, 6)) += block.U[k];
+                gc.rowRange(c, c + 6) += block.gc[k];
+            }
+        }
+
+        // Damp until a step lowers the error
+        bool improved = false;
+        while (!improved && lambda <= MAX_LM_DAMPING) {
+            // Reduced camera system S dc = rhs, with S = U - W^T V^-1 W and rhs = -gc + W^T V^-1 gb
+            cv::Mat S = damp(U, lambda);
+            cv::Mat rhs = -gc;
+            std::vector<cv::Mat> V_inv(num_frames);
+            for (int f = 0; f < num_frames; ++f) {
+                const FrameBlock& block = blocks[f];
+                if (by_frame[f].empty()) {
+                    continue;
+                }
+                cv::invert(damp(block.V, lambda), V_inv[f], cv::DECOMP_CHOLESKY);
+                for (size_t a = 0; a < block.cameras.size(); ++a) {
+                    int ca = 6 * (block.cameras[a] - 1);
+                    cv::Mat Y = block.W[a].t() * V_inv[f];
+                    rhs.rowRange(ca, ca + 6) += Y * block.g;
+                    for (size_t b = 0; b < block.cameras.size(); ++b) {
+                        int cb = 6 * (block.cameras[b] - 1);
+                        S(cv::Rect(cb, ca, 6, 6)) -= Y * block.W[b];
+                    }
+                }
+            }
+
+            cv::Mat dc = cv::Mat::zeros(m, 1, CV_64F);
+            if (m > 0 && !cv::solve(S, rhs, dc, cv::DECOMP_CHOLESKY)) {
+                lambda *= 10.0;
+                continue;
+            }
+
+            // Apply the camera step and back-substitute the board steps, db = -V^-1 (gb + W dc)
+            auto old_camera_rvecs = camera_rvecs_, old_camera_tvecs = camera_tvecs_;
+            auto old_board_rvecs = board_rvecs_, old_board_tvecs = board_tvecs_;
+            for (int c = 1; c < num_cameras; ++c) {
+                const double* d = dc.ptr<double>(6 * (c - 1));
+                camera_rvecs_[c] += cv::Vec3d(d[0], d[1], d[2]);
+                camera_tvecs_[c] += cv::Vec3d(d[3], d[4], d[5]);
+            }
+            for (int f = 0; f < num_frames; ++f) {
+                const FrameBlock& block = blocks[f];
+                if (by_frame[f].empty()) {
+                    continue;
+                }
+                cv::Mat b = block.g.clone();
+                for (size_t k = 0; k < block.cameras.size(); ++k) {
+                    int c = 6 * (block.cameras[k] - 1);
+                    b += block.W[k] * dc.rowRange(c, c + 6);
+                }
+                cv::Mat db = -V_inv[f] * b;
+                board_rvecs_[f] += cv::Vec3d(db.at<double>(0), db.at<double>(1), db.at<double>(2));
+                board_tvecs_[f] += cv::Vec3d(db.at<double>(3), db.at<double>(4), db.at<double>(5));
+            }
+
+            double new_error = total_error(num_points);
+            if (new_error < error) {
+                improved = true;
+                bool done = (error - new_error) < MIN_REL_IMPROVEMENT * error;
+                error = new_error;
+                lambda *= 0.1;
+                if (done) {
+                    return;
+                }
+            }
+            else {
+                camera_rvecs_ = old_camera_rvecs;
+                camera_tvecs_ = old_camera_tvecs;
+                board_rvecs_ = old_board_rvecs;
+                board_tvecs_ = old_board_tvecs;
+                lambda *= 10.0;
+            }
+        }
+        if (!improved) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Sum the squared reprojection error of all observations
+ * @param num_points Output number of projected points
+ * @return Sum of squared residuals, in pixels squared
+ */
+double RigCalibrator::total_error(size_t& num_points) const {
+    double sq = 0.0;
+    num_points = 0;
+    for (const auto& obs : linked_) {
+        if (!board_valid_[obs.frame]) {
+            continue;
+        }
+
+        cv::Vec3d rvec, tvec;
+        compose_pose(board_rvecs_[obs.frame], board_tvecs_[obs.frame], camera_rvecs_[obs.camera], camera_tvecs_[obs.camera], rvec, tvec);
+
+        const Calibrator& camera = cameras_[obs.camera];
+        std::vector<cv::Point2f> proj;
+        cv::projectPoints(object_pts_, rvec, tvec, camera.get_camera_matrix(), camera.get_dist_coeffs(), proj);
+        for (size_t k = 0; k < proj.size(); ++k) {
+            cv::Point2f d = proj[k] - obs.image_pts[k];
+            sq += d.x * d.x + d.y * d.y;
+        }
+        num_points += proj.size();
+    }
+    return sq;
+}
+
+/**
+ * @brief Save intrinsics and camera-to-rig extrinsics of all cameras to a single rig file
+ *
+ * The file can be loaded later using OpenCV FileStorage
+ * @param filename Output filename, YAML or XML supported by OpenCV
+ */
+void RigCalibrator::save(const std::string& filename) const {
+    cv::FileStorage fs(filename, cv::FileStorage::WRITE);
+    fs << "cameraCount" << (int)cameras_.size();
+    fs << "reprojError" << reproj_error_;
+    fs << "cameras" << "[";
+    for (size_t c = 0; c < cameras_.size(); ++c) {
+        cv::Matx33d R;
+        cv::Rodrigues(camera_rvecs_[c], R);
+
+        fs << "{";
+        fs << "imageWidth" << image_sizes_[c].width;
+        fs << "imageHeight" << image_sizes_[c].height;
+        fs << "cameraMatrix" << cameras_[c].get_camera_matrix();
+        fs << "distCoeffs" << cameras_[c].get_dist_coeffs();
+        fs << "intrinsicsReprojError" << cameras_[c].get_reproj_error();
+        fs << "R" << cv::Mat(R);
+        fs << "t" << cv::Mat(camera_tvecs_[c]);
+        fs << "}";
+    }
+    fs << "]";
+    fs.release();
+}
+
+/**
+ * @brief Get the number of cameras in the rig
+ * @return Number of cameras
+ */
+size_t RigCalibrator::get_num_cameras() const {
+    return cameras_.size();
+}
+
+/**
+ * @brief Get the number of observations of a camera
+ * @param camera Index of the camera
+ * @return Number of detections added for this camera
+ */
+size_t RigCalibrator::get_num_observations(size_t camera) const {
+    return cameras_[camera].get_num_samples();
+}
+
+/**
+ * @brief Get the intrinsics calibrator of a camera
+ * @param camera Index of the camera
+ * @return Reference to the calibrator
+ */
+const Calibrator& RigCalibrator::get_camera(size_t camera) const {
+    return cameras_[camera];
+}
+
+/**
+ * @brief Get the pose of a camera with respect to the rig, rig to camera coordinates
+ * @param camera Index of the camera
+ * @param rvec Output rotation vector, Rodrigues
+ * @param tvec Output translation vector
+ */
+void RigCalibrator::get_extrinsics(size_t camera, cv::Vec3d& rvec, cv::Vec3d& tvec) const {
+    rvec = camera_rvecs_[camera];
+    tvec = camera_tvecs_[camera];
+}
+
+/**
+ * @brief Get the RMS reprojection error of the joint extrinsics solution
+ * @return Reprojection error, lower is better
+ */
+double RigCalibrator::get_reproj_error() const {
+    return reproj_error_;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "calibrator.hpp"
+
+
+/**
+ * @class RigCalibrator
+ * @brief Calibrate a rig of cameras with overlapping views of the chessboard
+ *
+ * Collect detections per camera and per synchronized frame. Calibrate the intrinsics of all cameras
+ * concurrently from every view of each camera, then solve all camera-to-rig extrinsics and the board
+ * pose of every frame seen by two or more cameras in one joint Levenberg-Marquardt minimization of
+ * the reprojection error. Camera 0 defines the rig frame
+ */
+class RigCalibrator {
+public:
+    /**
+     * @brief Construct a new RigCalibrator object
+     * @param num_cameras Number of cameras in the rig
+     * @param object_pts 3D object points of the chessboard model, shared by all observations
+     */
+    RigCalibrator(size_t num_cameras, const std::vector<cv::Point3f>& object_pts);
+
+    /**
+     * @brief Add the detection of one camera in one synchronized frame
+     * @param frame Index of the synchronized frame
+     * @param camera Index of the camera
+     * @param image_pts 2D image points, A1 order
+     */
+    void add_observation(int frame, size_t camera, const std::vector<cv::Point2f>& image_pts);
+
+    /**
+     * @brief Run the intrinsics and the joint extrinsics calibration
+     * @param image_sizes Image size of every camera
+     * @return true if every camera is calibrated and connected to the rig, false otherwise
+     */
+    bool calibrate(const std::vector<cv::Size>& image_sizes);
+
+    /**
+     * @brief Save intrinsics and camera-to-rig extrinsics of all cameras to a single rig file
+     * @param filename Output filename, YAML or XML supported by OpenCV
+     */
+    void save(const std::string& filename) const;
+
+    /**
+     * @brief Get the number of cameras in the rig
+     * @return Number of cameras
+     */
+    size_t get_num_cameras() const;
+
+    /**
+     * @brief Get the number of observations of a camera
+     * @param camera Index of the camera
+     * @return Number of detections added for this camera
+     */
+    size_t get_num_observations(size_t camera) const;
+
+    /**
+     * @brief Get the intrinsics calibrator of a camera
+     * @param camera Index of the camera
+     * @return Reference to the calibrator
+     */
+    const Calibrator& get_camera(size_t camera) const;
+
+    /**
+     * @brief Get the pose of a camera with respect to the rig, rig to camera coordinates
+     * @param camera Index of the camera
+     * @param rvec Output rotation vector, Rodrigues
+     * @param tvec Output translation vector
+     */
+    void get_extrinsics(size_t camera, cv::Vec3d& rvec, cv::Vec3d& tvec) const;
+
+    /**
+     * @brief Get the RMS reprojection error of the joint extrinsics solution
+     * @return Reprojection error, lower is better
+     */
+    double get_reproj_error() const;
+
+private:
+    /**
+     * @brief One camera seeing the board in one synchronized frame
+     */
+    struct Observation {
+        int frame;                            // Index of the synchronized frame
+        size_t camera;                        // Index of the camera
+        std::vector<cv::Point2f> image_pts;   // Detected corners, A1 order
+        cv::Vec3d rvec, tvec;                 // Board pose in this camera from its intrinsics
+    };
+
+    /**
+     * @brief Chain the per-view board poses into an initial camera-to-rig estimate
+     * @return true if every camera is connected to camera 0 by shared frames
+     */
+    bool initialize_extrinsics();
+
+    /**
+     * @brief Refine all board poses and camera extrinsics jointly
+     * @param max_iterations Maximum number of Levenberg-Marquardt iterations
+     */
+    void refine_extrinsics(int max_iterations);
+
+    /**
+     * @brief Sum the squared reprojection error of all observations
+     * @param num_points Output number of projected points
+     * @return Sum of squared residuals, in pixels squared
+     */
+    double total_error(size_t& num_points) const;
+
+    double reproj_error_ = 0.0;
+
+    std::vector<cv::Point3f> object_pts_;
+    std::vector<Calibrator> cameras_;
+    std::vector<cv::Size> image_sizes_;
+    std::vector<Observation> observations_;               // Every view, all of them calibrate the intrinsics
+    std::vector<Observation> linked_;                     // Views of frames seen by two or more cameras, for the extrinsics
+
+    std::vector<cv::Vec3d> camera_rvecs_, camera_tvecs_;   // Rig to camera, camera 0 is the identity
+    std::vector<cv::Vec3d> board_rvecs_, board_tvecs_;     // Board to rig, per synchronized frame
+    std::vector<bool> board_valid_;                        // Frames with a board pose estimate
+};
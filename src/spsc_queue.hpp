@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @class SpscQueue
+ * @brief Bounded lock-free queue for one producer thread and one consumer thread
+ *
+ * Pushing never blocks: when the queue is full the push fails and the caller decides whether to drop
+ * or retry. The capacity is rounded up to a power of two
+ * @tparam T Element type, default constructible and movable
+ */
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * @brief Construct a new SpscQueue object
+     * @param capacity Minimum number of elements the queue can hold
+     */
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    /**
+     * @brief Append an element, producer thread only
+     * @param value Element to append, moved from on success
+     * @return true if the element was queued, false if the queue is full
+     */
+    bool try_push(T&& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) {
+            return false;
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Append a copy of an element, producer thread only
+     * @param value Element to append
+     * @return true if the element was queued, false if the queue is full
+     */
+    bool try_push(const T& value) {
+        T copy = value;
+        return try_push(std::move(copy));
+    }
+
+    /**
+     * @brief Remove the oldest element, consumer thread only
+     * @param value Output element
+     * @return true if an element was removed, false if the queue is empty
+     */
+    bool try_pop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Get the number of queued elements, exact only when both threads are idle
+     * @return Number of queued elements
+     */
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get the number of elements the queue can hold
+     * @return Capacity
+     */
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+
+    alignas(64) std::atomic<size_t> head_{0};   // Next element to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail_{0};   // Next free slot, written by the producer
+};
@@ -0,0 +1,241 @@
+#include "stereo_calibrator.hpp"
+
+#include <algorithm>
+#include <future>
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "chessboard.hpp"
+
+
+/**
+ * @brief Get the pose of the right camera in the left camera's coordinates from one board pose per view
+ * @param left_rvec, left_tvec Board pose in the left view
+ * @param right_rvec, right_tvec Board pose in the right view
+ * @param rvec Output rotation, left to right camera coordinates
+ * @param tvec Output translation, left to right camera coordinates
+ */
+static void relative_pose(const cv::Vec3d& left_rvec, const cv::Vec3d& left_tvec, const cv::Vec3d& right_rvec,
+                          const cv::Vec3d& right_tvec, cv::Vec3d& rvec, cv::Vec3d& tvec)
+{
+    cv::Matx33d R;
+    cv::Rodrigues(left_rvec, R);
+    cv::Vec3d left_rvec_inv;
+    cv::Rodrigues(R.t(), left_rvec_inv);
+    cv::composeRT(left_rvec_inv, cv::Vec3d(-(R.t() * left_tvec)), right_rvec, right_tvec, rvec, tvec);
+}
+
+/**
+ * @brief Measure how far apart two relative poses are
+ * @return Rotation angle between them plus their translation distance relative to the longer translation,
+ *         symmetric so that the medoid does not favor long translations
+ */
+static double pose_distance(const cv::Vec3d& rvec1, const cv::Vec3d& tvec1, const cv::Vec3d& rvec2, const cv::Vec3d& tvec2) {
+    cv::Matx33d R1, R2;
+    cv::Rodrigues(rvec1, R1);
+    cv::Rodrigues(rvec2, R2);
+    cv::Vec3d r_diff;
+    cv::Rodrigues(R1.t() * R2, r_diff);
+    return cv::norm(r_diff) + cv::norm(tvec1 - tvec2) / (std::max(cv::norm(tvec1), cv::norm(tvec2)) + 1e-9);
+}
+
+
+/**
+ * @brief Add a pair of detections of the same board pose
+ *
+ * Each view is also added to the calibrator of its camera for the intrinsics
+ * @param left_pts 2D image points in the left view, A1 order
+ * @param right_pts 2D image points in the right view, A1 order
+ * @param object_pts Corresponding 3D object points, chessboard model
+ */
+void StereoCalibrator::add_pair(const std::vector<cv::Point2f>& left_pts, const std::vector<cv::Point2f>& right_pts,
+                                const std::vector<cv::Point3f>& object_pts)
+{
+    left_.add_sample(left_pts, object_pts);
+    right_.add_sample(right_pts, object_pts);
+
+    left_points_.push_back(left_pts);
+    right_points_.push_back(right_pts);
+    object_points_.push_back(object_pts);
+}
+
+/**
+ * @brief Get the number of collected pairs
+ * @return Number of pairs added so far
+ */
+size_t StereoCalibrator::get_num_pairs() const {
+    return object_points_.size();
+}
+
+/**
+ * @brief Run the stereo calibration and compute the rectification maps
+ *
+ * Calibrate both cameras concurrently, each with the size of its own images, align the board ordering
+ * of the pairs, then run stereoCalibrate
+ * with fixed intrinsics, stereoRectify, and build fixed-point rectification maps once for later remapping.
+ * stereoRectify takes one image size for both cameras, so a pair of different sizes is rejected rather
+ * than rectified with the wrong size for one of them
+ * @param left_size Size of the images of the left camera
+ * @param right_size Size of the images of the right camera
+ * @return true if calibration is performed, false if not enough data or the sizes differ
+ */
+bool StereoCalibrator::calibrate(const cv::Size& left_size, const cv::Size& right_size) {
+    if (object_points_.empty() || left_size != right_size) {
+        return false; // No data to calibrate, or no common size to rectify to
+    }
+
+    // Intrinsics of both cameras are independent
+    auto right_done = std::async(std::launch::async, [&] { return right_.calibrate(right_size); });
+    bool left_ok = left_.calibrate(left_size);
+    bool right_ok = right_done.get();
+    if (!left_ok || !right_ok) {
+        return false;
+    }
+
+    cv::Mat K1 = left_.get_camera_matrix().clone();
+    cv::Mat D1 = left_.get_dist_coeffs().clone();
+    cv::Mat K2 = right_.get_camera_matrix().clone();
+    cv::Mat D2 = right_.get_dist_coeffs().clone();
+
+    // Both views of a pair must label the same physical corner as A1, or the pair is a false correspondence
+    align_pairs();
+
+    // Relative pose of the right camera with respect to the left, the size only seeds intrinsics, which are fixed
+    reproj_error_ = cv::stereoCalibrate(object_points_, left_points_, right_points_, K1, D1, K2, D2,
+                                        left_size, R_, T_, E_, F_, cv::CALIB_FIX_INTRINSIC);
+
+    // Rectification transforms and cached maps, each camera mapped at its own size
+    cv::stereoRectify(K1, D1, K2, D2, left_size, R_, T_, R1_, R2_, P1_, P2_, Q_, cv::CALIB_ZERO_DISPARITY, 0);
+    cv::initUndistortRectifyMap(K1, D1, R1_, P1_, left_size, CV_16SC2, left_map1_, left_map2_);
+    cv::initUndistortRectifyMap(K2, D2, R2_, P2_, right_size, CV_16SC2, right_map1_, right_map2_);
+    return true;
+}
+
+/**
+ * @brief Give the right view of every pair the board ordering of its left view
+ *
+ * The board looks the same after a half turn, so each view picks one of two equally good A1 orderings
+ * on its own. The left-to-right camera pose is the same for every pair, while a right view in the other
+ * ordering gives that pose turned by half a turn about the board center. Every pair yields the pose
+ * with its right view as detected and turned, the medoid of all of them is the true pose since the turned
+ * ones scatter as the board moves, and right views whose turned pose is closer to it are turned
+ */
+void StereoCalibrator::align_pairs() {
+    size_t num_pairs = object_points_.size();
+    std::vector<cv::Vec3d> rvecs(2 * num_pairs), tvecs(2 * num_pairs);
+    std::vector<cv::Vec3d> right_rvecs(num_pairs), right_tvecs(num_pairs);
+    cv::parallel_for_(cv::Range(0, (int)num_pairs), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            cv::Vec3d left_rvec, left_tvec;
+            cv::solvePnP(object_points_[i], left_points_[i], left_.get_camera_matrix(), left_.get_dist_coeffs(), left_rvec, left_tvec);
+            cv::solvePnP(object_points_[i], right_points_[i], right_.get_camera_matrix(), right_.get_dist_coeffs(),
+                         right_rvecs[i], right_tvecs[i]);
+
+            // Relative pose with the right view as detected, then with the right view turned
+            relative_pose(left_rvec, left_tvec, right_rvecs[i], right_tvecs[i], rvecs[2 * i], tvecs[2 * i]);
+            std::vector<cv::Point2f> turned = right_points_[i];
+            cv::Vec3d turned_rvec = right_rvecs[i], turned_tvec = right_tvecs[i];
+            Chessboard::half_turn(turned, object_points_[i], turned_rvec, turned_tvec);
+            relative_pose(left_rvec, left_tvec, turned_rvec, turned_tvec, rvecs[2 * i + 1], tvecs[2 * i + 1]);
+        }
+    });
+
+    size_t medoid = 0;
+    double best_sum = 1e300;
+    for (size_t i = 0; i < rvecs.size(); ++i) {
+        double sum = 0.0;
+        for (size_t j = 0; j < rvecs.size(); ++j) {
+            sum += pose_distance(rvecs[i], tvecs[i], rvecs[j], tvecs[j]);
+        }
+        if (sum < best_sum) {
+            best_sum = sum;
+            medoid = i;
+        }
+    }
+
+    for (size_t i = 0; i < num_pairs; ++i) {
+        double as_detected = pose_distance(rvecs[medoid], tvecs[medoid], rvecs[2 * i], tvecs[2 * i]);
+        double turned = pose_distance(rvecs[medoid], tvecs[medoid], rvecs[2 * i + 1], tvecs[2 * i + 1]);
+        if (turned < as_detected) {
+            Chessboard::half_turn(right_points_[i], object_points_[i], right_rvecs[i], right_tvecs[i]);
+        }
+    }
+}
+
+/**
+ * @brief Rectify a pair of images with the cached maps
+ * @param left Left input image
+ * @param right Right input image
+ * @param left_rect Output rectified left image
+ * @param right_rect Output rectified right image
+ */
+void StereoCalibrator::rectify(const cv::Mat& left, const cv::Mat& right, cv::Mat& left_rect, cv::Mat& right_rect) const {
+    cv::remap(left, left_rect, left_map1_, left_map2_, cv::INTER_LINEAR);
+    cv::remap(right, right_rect, right_map1_, right_map2_, cv::INTER_LINEAR);
+}
+
+/**
+ * @brief Save intrinsics, extrinsics, and rectification transforms to a file
+ *
+ * The file can be loaded later using OpenCV FileStorage
+ * @param filename Output filename, YAML or XML supported by OpenCV
+ */
+void StereoCalibrator::save(const std::string& filename) const {
+    cv::FileStorage fs(filename, cv::FileStorage::WRITE);
+    fs << "cameraMatrixLeft" << left_.get_camera_matrix();
+    fs << "distCoeffsLeft" << left_.get_dist_coeffs();
+    fs << "cameraMatrixRight" << right_.get_camera_matrix();
+    fs << "distCoeffsRight" << right_.get_dist_coeffs();
+    fs << "R" << R_;
+    fs << "T" << T_;
+    fs << "E" << E_;
+    fs << "F" << F_;
+    fs << "R1" << R1_;
+    fs << "R2" << R2_;
+    fs << "P1" << P1_;
+    fs << "P2" << P2_;
+    fs << "Q" << Q_;
+    fs << "reprojError" << reproj_error_;
+    fs.release();
+}
+
+/**
+ * @brief Get the calibrator of the left camera
+ * @return Reference to the left calibrator
+ */
+const Calibrator& StereoCalibrator::get_left() const {
+    return left_;
+}
+
+/**
+ * @brief Get the calibrator of the right camera
+ * @return Reference to the right calibrator
+ */
+const Calibrator& StereoCalibrator::get_right() const {
+    return right_;
+}
+
+/**
+ * @brief Get the rotation from the left to the right camera
+ * @return Reference to the 3x3 rotation matrix
+ */
+const cv::Mat& StereoCalibrator::get_rotation() const {
+    return R_;
+}
+
+/**
+ * @brief Get the translation from the left to the right camera
+ * @return Reference to the 3x1 translation vector
+ */
+const cv::Mat& StereoCalibrator::get_translation() const {
+    return T_;
+}
+
+/**
+ * @brief Get the reprojection error of the stereo calibration
+ * @return Reprojection error, lower is better
+ */
+double StereoCalibrator::get_reproj_error() const {
+    return reproj_error_;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "calibrator.hpp"
+
+
+/**
+ * @class StereoCalibrator
+ * @brief Calibrate a stereo pair: intrinsics per camera, stereo extrinsics, and rectification
+ *
+ * Accumulate chessboard detections seen by both cameras at the same time. Calibrate each camera
+ * on its own, align the board ordering of both views of every pair, then solve the relative pose
+ * with fixed intrinsics and cache the rectification maps
+ */
+class StereoCalibrator {
+public:
+    /**
+     * @brief Add a pair of detections of the same board pose
+     * @param left_pts 2D image points in the left view, A1 order
+     * @param right_pts 2D image points in the right view, A1 order
+     * @param object_pts Corresponding 3D object points, chessboard model
+     */
+    void add_pair(const std::vector<cv::Point2f>& left_pts, const std::vector<cv::Point2f>& right_pts,
+                  const std::vector<cv::Point3f>& object_pts);
+
+    /**
+     * @brief Get the number of collected pairs
+     * @return Number of pairs added so far
+     */
+    size_t get_num_pairs() const;
+
+    /**
+     * @brief Run the stereo calibration and compute the rectification maps
+     * @param left_size Size of the images of the left camera
+     * @param right_size Size of the images of the right camera
+     * @return true if calibration is performed, false if not enough data or the sizes differ
+     */
+    bool calibrate(const cv::Size& left_size, const cv::Size& right_size);
+
+    /**
+     * @brief Rectify a pair of images with the cached maps
+     * @param left Left input image
+     * @param right Right input image
+     * @param left_rect Output rectified left image
+     * @param right_rect Output rectified right image
+     */
+    void rectify(const cv::Mat& left, const cv::Mat& right, cv::Mat& left_rect, cv::Mat& right_rect) const;
+
+    /**
+     * @brief Save intrinsics, extrinsics, and rectification transforms to a file
+     * @param filename Output filename, YAML or XML supported by OpenCV
+     */
+    void save(const std::string& filename) const;
+
+    /**
+     * @brief Get the calibrator of the left camera
+     * @return Reference to the left calibrator
+     */
+    const Calibrator& get_left() const;
+
+    /**
+     * @brief Get the calibrator of the right camera
+     * @return Reference to the right calibrator
+     */
+    const Calibrator& get_right() const;
+
+    /**
+     * @brief Get the rotation from the left to the right camera
+     * @return Reference to the 3x3 rotation matrix
+     */
+    const cv::Mat& get_rotation() const;
+
+    /**
+     * @brief Get the translation from the left to the right camera
+     * @return Reference to the 3x1 translation vector
+     */
+    const cv::Mat& get_translation() const;
+
+    /**
+     * @brief Get the reprojection error of the stereo calibration
+     * @return Reprojection error, lower is better
+     */
+    double get_reproj_error() const;
+
+private:
+    /**
+     * @brief Give the right view of every pair the board ordering of its left view
+     */
+    void align_pairs();
+
+    double reproj_error_ = 0.0;
+
+    Calibrator left_;
+    Calibrator right_;
+
+    std::vector<std::vector<cv::Point2f>> left_points_;
+    std::vector<std::vector<cv::Point2f>> right_points_;
+    std::vector<std::vector<cv::Point3f>> object_points_;
+
+    cv::Mat R_, T_, E_, F_;            // Stereo extrinsics, essential and fundamental matrix
+    cv::Mat R1_, R2_, P1_, P2_, Q_;    // Rectification transforms
+    cv::Mat left_map1_, left_map2_;    // Cached rectification maps, CV_16SC2 and CV_16UC1
+    cv::Mat right_map1_, right_map2_;
+};
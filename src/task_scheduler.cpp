@@ -0,0 +1,295 @@
+#include "task_scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <iterator>
+
+
+constexpr int SPIN_LIMIT = 64;            // Failed attempts before a waiting caller sleeps
+constexpr int BACKOFF_US = 50;            // Sleep of a waiting caller with nothing to run
+
+// Pool and index of the calling thread, set on the pool threads only
+static thread_local const TaskScheduler* current_scheduler = nullptr;
+static thread_local int current_worker = -1;
+
+// Group of the task the calling thread is running, null outside tasks
+static thread_local TaskGroup* current_group = nullptr;
+
+
+/**
+ * @brief Construct a new TaskScheduler object and start the pool
+ * @param threads Number of pool threads, 0 for all hardware threads
+ */
+TaskScheduler::TaskScheduler(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+
+    // Start the threads once all deques exist, they steal from each other
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_[i]->thread = std::thread(&TaskScheduler::run, this, (int)i);
+    }
+}
+
+/**
+ * @brief Run the queued tasks and stop the pool
+ */
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        running_ = false;
+    }
+    work_ready_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+/**
+ * @brief Queue a task, on the deque of the calling pool thread or spread over the deques from other threads
+ * @param group Group the task belongs to, must outlive the task
+ * @param task Task to run
+ */
+void TaskScheduler::spawn(TaskGroup& group, Task task) {
+    int index = current_index();
+    Worker& worker = index >= 0 ? *workers_[index] : *workers_[next_deque_.fetch_add(1, std::memory_order_relaxed) % workers_.size()];
+
+    // Count before queueing, so a thread taking the task never sees a negative count. The first task
+    // of a batch links the group to the task spawning it, later ones come from the group's own tasks
+    if (group.pending_.fetch_add(1, std::memory_order_relaxed) == 0) {
+        group.parent_.store(current_group, std::memory_order_relaxed);
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.jobs.push_back(Job{ std::move(task), &group });
+    }
+
+    // Pass through the idle lock, so a thread about to sleep sees the task or the notification
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+    }
+    work_ready_.notify_one();
+}
+
+/**
+ * @brief Wait until all tasks of a group have finished, running queued tasks of the group and its descendants meanwhile
+ *
+ * The waiting thread helps only with work it waits for: tasks of the group, and tasks those spawned
+ * into other groups, e.g. the pose candidates of a frame. It never starts an unrelated task, such as
+ * a later frame, whose cost would delay the return. Other tasks are left to the pool threads
+ * @param group Group to wait for
+ */
+void TaskScheduler::wait(TaskGroup& group) {
+    int index = current_index();
+    int spins = 0;
+    while (!group.is_done()) {
+        Job job;
+        if (take(index, job, &group)) {
+            execute(job, index);
+            spins = 0;
+        }
+        else if (++spins < SPIN_LIMIT) {
+            std::this_thread::yield();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::microseconds(BACKOFF_US));
+        }
+    }
+}
+
+/**
+ * @brief Call a function for every index of a range, split in halves that idle threads can steal
+ * @param begin First index
+ * @param end One past the last index
+ * @param fn Function of the index, called concurrently
+ * @param grain Largest number of indices run without splitting
+ */
+void TaskScheduler::parallel_for(int begin, int end, const std::function<void(int)>& fn, int grain) {
+    if (end <= begin) {
+        return;
+    }
+
+    TaskGroup group;
+    split(group, begin, end, fn, std::max(1, grain));
+    wait(group);
+}
+
+/**
+ * @brief Get the number of pool threads
+ * @return Number of threads
+ */
+unsigned TaskScheduler::get_num_threads() const {
+    return (unsigned)workers_.size();
+}
+
+/**
+ * @brief Get the counters of every pool thread
+ *
+ * Tasks run by a caller of wait outside the pool are not counted
+ * @return One entry per thread
+ */
+std::vector<WorkerStats> TaskScheduler::get_stats() const {
+    std::vector<WorkerStats> stats;
+    for (const auto& worker : workers_) {
+        WorkerStats entry;
+        entry.executed = worker->executed.load(std::memory_order_relaxed);
+        entry.stolen = worker->stolen.load(std::memory_order_relaxed);
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+/**
+ * @brief Pool thread loop, run own and stolen tasks until stopped and no task is queued
+ * @param index Index of the thread
+ */
+void TaskScheduler::run(int index) {
+    current_scheduler = this;
+    current_worker = index;
+
+    while (true) {
+        Job job;
+        if (take(index, job)) {
+            execute(job, index);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        work_ready_.wait(lock, [&]() { return queued_.load(std::memory_order_acquire) > 0 || !running_; });
+        if (!running_ && queued_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Take a task, from the back of the own deque or the front of another
+ *
+ * The own deque yields the newest task, whose data is likely still cached; other deques yield
+ * their oldest task, the largest piece of a split range. With a scope, the newest or oldest task
+ * within the scope is taken
+ * @param index Index of the calling pool thread, -1 for other threads
+ * @param job Output task
+ * @param scope Take only tasks of this group and its descendants, null for any task
+ * @return true if a task was taken
+ */
+bool TaskScheduler::take(int index, Job& job, const TaskGroup* scope) {
+    if (queued_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    if (index >= 0) {
+        Worker& own = *workers_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        for (auto it = own.jobs.rbegin(); it != own.jobs.rend(); ++it) {
+            if (scope == nullptr || is_within(it->group, scope)) {
+                job = std::move(*it);
+                own.jobs.erase(std::next(it).base());
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    const int n = (int)workers_.size();
+    for (int k = 1; k <= n; ++k) {
+        int victim = (std::max(index, 0) + k) % n;
+        if (victim == index) {
+            continue;
+        }
+        Worker& other = *workers_[victim];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        for (auto it = other.jobs.begin(); it != other.jobs.end(); ++it) {
+            if (scope == nullptr || is_within(it->group, scope)) {
+                job = std::move(*it);
+                other.jobs.erase(it);
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                if (index >= 0) {
+                    workers_[index]->stolen.fetch_add(1, std::memory_order_relaxed);
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Check if a group is a scope or was spawned into, directly or not, by tasks of the scope
+ *
+ * Ancestors stay alive while a descendant has queued tasks, since the spawning task waits for them
+ * @param group Group of a queued task
+ * @param scope Group waited for
+ * @return true if tasks of the group may run while waiting for the scope
+ */
+bool TaskScheduler::is_within(const TaskGroup* group, const TaskGroup* scope) {
+    for (; group != nullptr; group = group->parent_.load(std::memory_order_relaxed)) {
+        if (group == scope) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Run a task and mark it finished in its group
+ *
+ * A failing task is reported and still marked finished, so waiting callers do not hang
+ * @param job Task to run
+ * @param index Index of the calling pool thread, -1 for other threads
+ */
+void TaskScheduler::execute(Job& job, int index) {
+    // Groups spawned into by the task become its group's descendants
+    TaskGroup* outer_group = current_group;
+    current_group = job.group;
+    try {
+        job.task();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Task failed: " << e.what() << '\n';
+    }
+    current_group = outer_group;
+
+    if (index >= 0) {
+        workers_[index]->executed.fetch_add(1, std::memory_order_relaxed);
+    }
+    job.group->pending_.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Split a range in halves until it is at most the grain, spawning the upper halves
+ *
+ * The thread keeps the lower half and spawns the upper one, which thieves take first, so large
+ * pieces move between threads and small ones stay local
+ * @param group Group of the spawned halves
+ * @param begin First index
+ * @param end One past the last index
+ * @param fn Function of the index
+ * @param grain Largest number of indices run without splitting
+ */
+void TaskScheduler::split(TaskGroup& group, int begin, int end, const std::function<void(int)>& fn, int grain) {
+    while (end - begin > grain) {
+        int mid = begin + (end - begin) / 2;
+        spawn(group, [this, &group, mid, end, &fn, grain]() { split(group, mid, end, fn, grain); });
+        end = mid;
+    }
+    for (int i = begin; i < end; ++i) {
+        fn(i);
+    }
+}
+
+/**
+ * @brief Get the index of the calling thread in this pool
+ * @return Index, -1 if the caller is not a thread of this pool
+ */
+int TaskScheduler::current_index() const {
+    return current_scheduler == this ? current_worker : -1;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief Set of tasks that can be waited for together
+ */
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * @brief Check if all tasks of the group have finished
+     * @return true if no task of the group is queued or running
+     */
+    bool is_done() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class TaskScheduler;
+    std::atomic<size_t> pending_{0};            // Tasks spawned and not yet finished
+    std::atomic<TaskGroup*> parent_{nullptr};   // Group of the task that spawned into this group, null outside tasks
+};
+
+/**
+ * @brief Counters of one scheduler thread
+ */
+struct WorkerStats {
+    uint64_t executed = 0;      // Tasks run by the thread
+    uint64_t stolen = 0;        // Tasks taken from the deque of another thread
+};
+
+/**
+ * @class TaskScheduler
+ * @brief Work-stealing pool for tasks of uneven cost, with per-thread deques
+ *
+ * Every thread owns a deque. Tasks spawned by a pool thread go to the back of its own deque and are
+ * taken from the back again, newest first, so a thread finishes its own sub-tasks while they are
+ * hot in its cache. An idle thread steals from the front of the other deques, oldest first, which
+ * are the largest pieces of work. A slow task, e.g. a frame where the chessboard search fails,
+ * then only occupies one thread, and the sub-tasks it splits off, e.g. the pose candidates, can be
+ * picked up by the others. Waiting for a group runs queued tasks of that group and of the groups its
+ * tasks spawned into meanwhile, so tasks can spawn and wait for sub-tasks without blocking a thread,
+ * and a waiting caller never picks up unrelated work, e.g. a later frame, before its own
+ */
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Construct a new TaskScheduler object and start the pool
+     * @param threads Number of pool threads, 0 for all hardware threads
+     */
+    explicit TaskScheduler(unsigned threads = 0);
+
+    /**
+     * @brief Run the queued tasks and stop the pool
+     */
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief Queue a task, on the deque of the calling pool thread or spread over the deques from other threads
+     *
+     * A task spawning into a group must wait for that group before it returns
+     * @param group Group the task belongs to, must outlive the task
+     * @param task Task to run
+     */
+    void spawn(TaskGroup& group, Task task);
+
+    /**
+     * @brief Wait until all tasks of a group have finished, running queued tasks of the group and its descendants meanwhile
+     * @param group Group to wait for
+     */
+    void wait(TaskGroup& group);
+
+    /**
+     * @brief Call a function for every index of a range, split in halves that idle threads can steal
+     * @param begin First index
+     * @param end One past the last index
+     * @param fn Function of the index, called concurrently
+     * @param grain Largest number of indices run without splitting
+     */
+    void parallel_for(int begin, int end, const std::function<void(int)>& fn, int grain = 1);
+
+    /**
+     * @brief Get the number of pool threads
+     * @return Number of threads
+     */
+    unsigned get_num_threads() const;
+
+    /**
+     * @brief Get the counters of every pool thread
+     * @return One entry per thread
+     */
+    std::vector<WorkerStats> get_stats() const;
+
+private:
+    /**
+     * @brief Queued task with its group
+     */
+    struct Job {
+        Task task;
+        TaskGroup* group = nullptr;
+    };
+
+    /**
+     * @brief Deque and counters of one pool thread
+     */
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+        std::thread thread;
+    };
+
+    /**
+     * @brief Pool thread loop, run own and stolen tasks until stopped and no task is queued
+     * @param index Index of the thread
+     */
+    void run(int index);
+
+    /**
+     * @brief Take a task, from the back of the own deque or the front of another
+     * @param index Index of the calling pool thread, -1 for other threads
+     * @param job Output task
+     * @param scope Take only tasks of this group and its descendants, null for any task
+     * @return true if a task was taken
+     */
+    bool take(int index, Job& job, const TaskGroup* scope = nullptr);
+
+    /**
+     * @brief Check if a group is a scope or was spawned into, directly or not, by tasks of the scope
+     * @param group Group of a queued task
+     * @param scope Group waited for
+     * @return true if tasks of the group may run while waiting for the scope
+     */
+    static bool is_within(const TaskGroup* group, const TaskGroup* scope);
+
+    /**
+     * @brief Run a task and mark it finished in its group
+     * @param job Task to run
+     * @param index Index of the calling pool thread, -1 for other threads
+     */
+    void execute(Job& job, int index);
+
+    /**
+     * @brief Split a range in halves until it is at most the grain, spawning the upper halves
+     * @param group Group of the spawned halves
+     * @param begin First index
+     * @param end One past the last index
+     * @param fn Function of the index
+     * @param grain Largest number of indices run without splitting
+     */
+    void split(TaskGroup& group, int begin, int end, const std::function<void(int)>& fn, int grain);
+
+    /**
+     * @brief Get the index of the calling thread in this pool
+     * @return Index, -1 if the caller is not a thread of this pool
+     */
+    int current_index() const;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex idle_mutex_;
+    std::condition_variable work_ready_;    // A task was queued or the pool is stopping
+    std::atomic<size_t> queued_{0};         // Tasks in all deques
+    std::atomic<unsigned> next_deque_{0};   // Deque for the next task spawned from outside the pool
+    std::atomic<bool> running_{true};
+};
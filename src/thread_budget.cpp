@@ -0,0 +1,105 @@
+#include "thread_budget.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include <opencv2/core.hpp>
+
+
+/**
+ * @brief Construct a new ThreadBudget object
+ *
+ * Start with one frame worker and the whole budget for OpenCV, as for a single frame in flight
+ * @param budget Threads the session may keep busy, 0 for all hardware threads
+ * @param reserved Threads of the budget kept for other stages, e.g. rendering, at least one is left for frames
+ */
+ThreadBudget::ThreadBudget(unsigned budget, unsigned reserved)
+    : initial_cv_threads_(cv::getNumThreads())
+{
+    if (budget == 0) {
+        budget = std::max(1u, std::thread::hardware_concurrency());
+    }
+    available_ = budget > reserved ? budget - reserved : 1;
+
+    allocation_.budget = budget;
+    allocation_.frame_workers = 1;
+    allocation_.cv_threads = available_;
+    cv::setNumThreads((int)allocation_.cv_threads);
+}
+
+/**
+ * @brief Restore the OpenCV thread count found at construction
+ */
+ThreadBudget::~ThreadBudget() {
+    scheduler_.reset();
+    cv::setNumThreads(initial_cv_threads_);
+}
+
+/**
+ * @brief Split the budget for the number of frames that will be processed concurrently in the next phase
+ *
+ * Every frame up to the available threads gets a worker, the rest of the threads serve OpenCV;
+ * cv::setNumThreads is only called when the split changes. A pool of the wrong size is released and
+ * created again with the new frame workers on its next use. Call between phases only, with no task of
+ * the pool and no OpenCV call in flight: setNumThreads reconfigures OpenCV's pool, and with TBB it
+ * terminates the arena a running call may be using
+ * @param queue_depth Frames to process concurrently, at least one frame is assumed
+ * @return Allocation now in effect
+ */
+const ThreadAllocation& ThreadBudget::rebalance(size_t queue_depth) {
+    unsigned frame_workers = (unsigned)std::clamp<size_t>(queue_depth, 1, available_);
+    unsigned cv_threads = available_ - frame_workers + 1;
+    if (frame_workers != allocation_.frame_workers || cv_threads != allocation_.cv_threads) {
+        allocation_.frame_workers = frame_workers;
+        allocation_.cv_threads = cv_threads;
+        cv::setNumThreads((int)cv_threads);
+        ++changes_;
+    }
+    if (scheduler_ && scheduler_->get_num_threads() != pool_threads()) {
+        scheduler_.reset();
+    }
+    return allocation_;
+}
+
+/**
+ * @brief Get the allocation in effect
+ * @return Current allocation
+ */
+const ThreadAllocation& ThreadBudget::get_allocation() const {
+    return allocation_;
+}
+
+/**
+ * @brief Get the worker pool, created on first use with one thread less than the frame workers, the caller being the last
+ * @return Work-stealing pool owned by the budget
+ */
+TaskScheduler& ThreadBudget::get_scheduler() {
+    if (!scheduler_) {
+        scheduler_ = std::make_unique<TaskScheduler>(pool_threads());
+    }
+    return *scheduler_;
+}
+
+/**
+ * @brief Get the threads available for frame processing
+ * @return Budget minus the reserved threads, at least one
+ */
+unsigned ThreadBudget::get_available() const {
+    return available_;
+}
+
+/**
+ * @brief Get the number of times the allocation changed
+ * @return Number of reallocations
+ */
+uint64_t ThreadBudget::get_changes() const {
+    return changes_;
+}
+
+/**
+ * @brief Get the pool size for the current frame workers
+ * @return Frame workers minus the calling thread, at least one
+ */
+unsigned ThreadBudget::pool_threads() const {
+    return std::max(1u, allocation_.frame_workers - 1);
+}
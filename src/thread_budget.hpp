@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "task_scheduler.hpp"
+
+
+/**
+ * @brief Split of the thread budget between frames and OpenCV
+ */
+struct ThreadAllocation {
+    unsigned budget = 1;            // Threads the session may keep busy
+    unsigned frame_workers = 1;     // Frames processed concurrently, inter-frame parallelism
+    unsigned cv_threads = 1;        // Threads of an OpenCV call, intra-frame parallelism
+};
+
+/**
+ * @class ThreadBudget
+ * @brief Keep the threads of our worker pool and of OpenCV within one CPU budget
+ *
+ * OpenCV parallelizes calls such as cvtColor, Laplacian, and findChessboardCorners on its own pool,
+ * so running frames concurrently on our pool as well would multiply the thread counts. The budget
+ * owns our pool and sets the OpenCV thread count with cv::setNumThreads, which is process-wide. With
+ * many frames queued, frames run concurrently and OpenCV runs each call sequentially; with few frames
+ * queued, e.g. a live camera or the tail of a dataset, the spare threads go to OpenCV instead. The
+ * OpenCV pool serves one call at a time, concurrent calls run on their calling threads, so the
+ * frame workers and the OpenCV helper threads together stay within the budget. The pool has one
+ * thread less than the frame workers, the calling thread counts as the last, and callers keep at most
+ * that many frames in flight. The split is set once per phase, while nothing runs on either pool
+ */
+class ThreadBudget {
+public:
+    /**
+     * @brief Construct a new ThreadBudget object
+     * @param budget Threads the session may keep busy, 0 for all hardware threads
+     * @param reserved Threads of the budget kept for other stages, e.g. rendering, at least one is left for frames
+     */
+    explicit ThreadBudget(unsigned budget = 0, unsigned reserved = 0);
+
+    /**
+     * @brief Restore the OpenCV thread count found at construction
+     */
+    ~ThreadBudget();
+
+    ThreadBudget(const ThreadBudget&) = delete;
+    ThreadBudget& operator=(const ThreadBudget&) = delete;
+
+    /**
+     * @brief Split the budget for the number of frames that will be processed concurrently in the next phase
+     *
+     * Call between phases only, with no task of the pool and no OpenCV call in flight
+     * @param queue_depth Frames to process concurrently, at least one frame is assumed
+     * @return Allocation now in effect
+     */
+    const ThreadAllocation& rebalance(size_t queue_depth);
+
+    /**
+     * @brief Get the allocation in effect
+     * @return Current allocation
+     */
+    const ThreadAllocation& get_allocation() const;
+
+    /**
+     * @brief Get the worker pool, created on first use with one thread less than the frame workers, the caller being the last
+     * @return Work-stealing pool owned by the budget
+     */
+    TaskScheduler& get_scheduler();
+
+    /**
+     * @brief Get the threads available for frame processing
+     * @return Budget minus the reserved threads, at least one
+     */
+    unsigned get_available() const;
+
+    /**
+     * @brief Get the number of times the allocation changed
+     * @return Number of reallocations
+     */
+    uint64_t get_changes() const;
+
+private:
+    /**
+     * @brief Get the pool size for the current frame workers
+     * @return Frame workers minus the calling thread, at least one
+     */
+    unsigned pool_threads() const;
+
+    ThreadAllocation allocation_;
+    unsigned available_;
+    int initial_cv_threads_;            // OpenCV thread count to restore
+    uint64_t changes_ = 0;
+    std::unique_ptr<TaskScheduler> scheduler_;
+};
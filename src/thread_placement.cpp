@@ -0,0 +1,364 @@
+#include "thread_placement.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+// Roles a thread can enter
+static const std::set<std::string> THREAD_ROLES = { "capture", "detect", "render", "display" };
+
+/**
+ * @brief Record the final counters of the threads entered by the owning thread when it exits
+ */
+struct ExitRecorder {
+    std::vector<std::function<void()>> on_exit;
+
+    ~ExitRecorder() {
+        for (auto& fn : on_exit) {
+            fn();
+        }
+    }
+};
+
+
+/**
+ * @brief Set the CPUs of a thread role
+ * @param spec ROLE=CPUS, with CPUS a comma-separated list of CPUs and ranges, e.g. detect=2-5,8
+ * @return true if the spec was valid
+ */
+bool ThreadPlacement::add_pin(const std::string& spec) {
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos || !THREAD_ROLES.count(spec.substr(0, eq))) {
+        return false;
+    }
+
+    std::vector<int> cpus;
+    std::stringstream list(spec.substr(eq + 1));
+    std::string item;
+    try {
+        while (std::getline(list, item, ',')) {
+            size_t dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            if (first < 0 || last < first) {
+                return false;
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    catch (...) {
+        return false;
+    }
+    if (cpus.empty()) {
+        return false;
+    }
+
+    cpus_[spec.substr(0, eq)] = cpus;
+    return true;
+}
+
+/**
+ * @brief Set the real-time priority of the capture thread
+ * @param priority SCHED_FIFO priority, 1-99 on Linux, 0 for the default policy
+ */
+void ThreadPlacement::set_capture_priority(int priority) {
+    capture_priority_ = std::max(0, priority);
+}
+
+/**
+ * @brief Check if any pinning or priority is configured
+ * @return true if threads are placed, false if they only report their scheduling
+ */
+bool ThreadPlacement::is_configured() const {
+    return !cpus_.empty() || capture_priority_ > 0;
+}
+
+/**
+ * @brief Check if threads of a role are placed
+ * @param role Thread role: capture, detect, render, or display
+ * @return true if the role is pinned, or is capture with a real-time priority
+ */
+bool ThreadPlacement::places(const std::string& role) const {
+    return cpus_.count(role) > 0 || (role == "capture" && capture_priority_ > 0);
+}
+
+/**
+ * @brief Start OpenCV's worker threads on the calling thread
+ *
+ * OpenCV starts its workers lazily, from the first thread that runs a parallel loop, and a new thread
+ * inherits the CPUs of the thread that starts it. Started from an unplaced thread before any role is
+ * entered, the workers run on any CPU instead of sharing the CPUs of one role
+ */
+void ThreadPlacement::start_library_threads() {
+    int threads = cv::getNumThreads();
+    if (threads > 1) {
+        cv::parallel_for_(cv::Range(0, threads), [](const cv::Range&) {}, threads);
+    }
+}
+
+/**
+ * @brief Place the calling thread for its role and track its scheduling, call once at the start of the thread
+ *
+ * Pin before the thread allocates its buffers, so first touch places them on the node of its CPUs
+ * @param role Thread role: capture, detect, render, or display
+ */
+void ThreadPlacement::enter(const std::string& role) {
+    auto tracked = std::make_shared<Tracked>();
+    tracked->stats.role = role;
+    tracked->tid = current_tid();
+
+    auto it = cpus_.find(role);
+    if (it != cpus_.end()) {
+        tracked->stats.pinned = pin(it->second);
+        if (!tracked->stats.pinned) {
+            std::cerr << "Could not pin the " << role << " thread, it runs on any CPU." << '\n';
+        }
+    }
+
+    // Without the permission for real-time policies, e.g. CAP_SYS_NICE or RLIMIT_RTPRIO, keep the default policy
+    if (role == "capture" && capture_priority_ > 0) {
+        tracked->stats.realtime = make_realtime(capture_priority_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!tracked->stats.realtime && !warned_realtime_) {
+            std::cerr << "Could not give the capture thread real-time priority " << capture_priority_
+                      << ", missing permission, keeping the default policy." << '\n';
+            warned_realtime_ = true;
+        }
+    }
+
+    tracked->start = read_counters(tracked->tid);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.push_back(tracked);
+    }
+
+    // The thread's kernel counters are gone once it is joined, record them as it exits
+    thread_local ExitRecorder recorder;
+    recorder.on_exit.push_back([tracked]() {
+        std::lock_guard<std::mutex> lock(tracked->mutex);
+        update(*tracked, read_counters(tracked->tid));
+        tracked->finished = true;
+    });
+}
+
+/**
+ * @brief Print the CPUs and NUMA nodes of every pinned role, warn when capture and detection are on different nodes
+ */
+void ThreadPlacement::print_plan() const {
+    std::map<std::string, std::set<int>> role_nodes;
+    for (const auto& [role, cpus] : cpus_) {
+        std::set<int> nodes;
+        std::cout << "Thread role " << role << ": CPUs";
+        for (int cpu : cpus) {
+            std::cout << ' ' << cpu;
+            nodes.insert(cpu_node(cpu));
+        }
+        std::cout << ", NUMA nodes";
+        for (int node : nodes) {
+            std::cout << ' ' << (node >= 0 ? std::to_string(node) : std::string("unknown"));
+        }
+        std::cout << '\n';
+        role_nodes[role] = nodes;
+    }
+    if (capture_priority_ > 0) {
+        std::cout << "Capture thread priority: SCHED_FIFO " << capture_priority_ << '\n';
+    }
+
+    // Frames are first touched by the capture thread, detection on another node reads them remotely
+    auto capture = role_nodes.find("capture");
+    auto detect = role_nodes.find("detect");
+    if (capture != role_nodes.end() && detect != role_nodes.end() && !capture->second.count(-1) &&
+        !detect->second.count(-1) && capture->second != detect->second) {
+        std::cerr << "Capture and detection are pinned to different NUMA nodes, frames are read across nodes." << '\n';
+    }
+}
+
+/**
+ * @brief Print the scheduling counters of every entered thread
+ */
+void ThreadPlacement::report() const {
+    for (const auto& stats : get_sched_stats()) {
+        std::cout << "Thread " << stats.role << (stats.pinned ? " (pinned)" : "") << (stats.realtime ? " (SCHED_FIFO)" : "") << ": ";
+        if (!stats.available) {
+            std::cout << "scheduling counters not available" << '\n';
+            continue;
+        }
+        std::cout << "ran " << stats.run_ms << " ms, waited " << stats.wait_ms << " ms for a CPU over " << stats.slices
+                  << " slices (" << (stats.slices > 0 ? 1000.0 * stats.wait_ms / stats.slices : 0.0) << " us each), "
+                  << stats.preempted << " preemptions" << '\n';
+    }
+}
+
+/**
+ * @brief Get the scheduling counters of every entered thread, live threads are sampled now
+ * @return One entry per entered thread, in the order they entered
+ */
+std::vector<ThreadSchedStats> ThreadPlacement::get_sched_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ThreadSchedStats> stats;
+    for (const auto& tracked : threads_) {
+        std::lock_guard<std::mutex> thread_lock(tracked->mutex);
+        if (!tracked->finished) {
+            update(*tracked, read_counters(tracked->tid));
+        }
+        stats.push_back(tracked->stats);
+    }
+    return stats;
+}
+
+/**
+ * @brief Get the NUMA node of a CPU
+ * @param cpu CPU index
+ * @return Node index, -1 if unknown
+ */
+int ThreadPlacement::cpu_node(int cpu) {
+#if defined(__linux__)
+    // The CPU directory links to its node as nodeN
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/cpu/cpu" + std::to_string(cpu), ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.rfind("node", 0) == 0 && std::isdigit((unsigned char)name[4])) {
+            return std::atoi(name.c_str() + 4);
+        }
+    }
+#else
+    (void)cpu;
+#endif
+    return -1;
+}
+
+/**
+ * @brief Pin the calling thread to a set of CPUs
+ * @param cpus CPU indices
+ * @return true if the thread was pinned
+ */
+bool ThreadPlacement::pin(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        if (cpu < (int)(sizeof(DWORD_PTR) * 8)) {
+            mask |= (DWORD_PTR)1 << cpu;
+        }
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+/**
+ * @brief Switch the calling thread to SCHED_FIFO
+ *
+ * On Windows the thread gets time-critical priority instead
+ * @param priority Real-time priority
+ * @return true if the policy was applied
+ */
+bool ThreadPlacement::make_realtime(int priority) {
+#if defined(_WIN32)
+    (void)priority;
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+    sched_param param{};
+    param.sched_priority = std::clamp(priority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+#if defined(__linux__) && defined(SCHED_RESET_ON_FORK)
+    // Threads the capture thread starts, e.g. inside a capture backend, get the default policy
+    return sched_setscheduler(0, SCHED_FIFO | SCHED_RESET_ON_FORK, &param) == 0;
+#else
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#endif
+#endif
+}
+
+/**
+ * @brief Get the kernel id of the calling thread
+ * @return Thread id, 0 if unknown
+ */
+long ThreadPlacement::current_tid() {
+#if defined(__linux__)
+    return (long)syscall(SYS_gettid);
+#elif defined(_WIN32)
+    return (long)GetCurrentThreadId();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Read the kernel counters of a thread of this process
+ *
+ * schedstat holds the time on a CPU, the time waiting in the run queue, and the number of slices
+ * @param tid Kernel thread id
+ * @return Counters, not valid if they could not be read
+ */
+ThreadPlacement::Counters ThreadPlacement::read_counters(long tid) {
+    Counters counters;
+#if defined(__linux__)
+    std::string dir = "/proc/self/task/" + std::to_string(tid);
+    std::ifstream schedstat(dir + "/schedstat");
+    if (!(schedstat >> counters.run_ns >> counters.wait_ns >> counters.slices)) {
+        return counters;
+    }
+
+    std::ifstream status(dir + "/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("nonvoluntary_ctxt_switches:", 0) == 0) {
+            counters.preempted = std::stoull(line.substr(line.find(':') + 1));
+        }
+    }
+    counters.valid = true;
+#else
+    (void)tid;
+#endif
+    return counters;
+}
+
+/**
+ * @brief Store the counters since the thread entered its role
+ * @param tracked Entered thread, its mutex held
+ * @param now Current counters
+ */
+void ThreadPlacement::update(Tracked& tracked, const Counters& now) {
+    const Counters& start = tracked.start;
+    tracked.stats.available = start.valid && now.valid;
+    if (!tracked.stats.available) {
+        return;
+    }
+    tracked.stats.run_ms = (now.run_ns - start.run_ns) * 1e-6;
+    tracked.stats.wait_ms = (now.wait_ns - start.wait_ns) * 1e-6;
+    tracked.stats.slices = now.slices - start.slices;
+    tracked.stats.preempted = now.preempted - start.preempted;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+
+/**
+ * @brief Scheduling counters of one thread over its lifetime, from the kernel
+ */
+struct ThreadSchedStats {
+    std::string role;               // Role of the thread: capture, detect, render, or display
+    double run_ms = 0.0;            // Time running on a CPU
+    double wait_ms = 0.0;           // Time runnable but waiting for a CPU, the scheduling latency
+    uint64_t slices = 0;            // Times the thread was scheduled in
+    uint64_t preempted = 0;         // Involuntary context switches
+    bool pinned = false;            // Pinned to the CPUs of its role
+    bool realtime = false;          // Running with the SCHED_FIFO policy
+    bool available = false;         // The counters could be read
+};
+
+/**
+ * @class ThreadPlacement
+ * @brief Place the session threads on CPUs by role, optionally run capture with real-time priority, and report their scheduling
+ *
+ * Each thread enters its role once, at its start: it is pinned to the CPUs of the role, if any, and
+ * the capture thread gets SCHED_FIFO when a priority is set. Missing permissions for the real-time
+ * policy are reported once and the thread keeps the default policy. Frame buffers are placed by first
+ * touch: frames allocated by a pinned capture thread have their pages on that thread's NUMA node,
+ * so capture and detection should be pinned to CPUs of the same node. The kernel's run-queue wait of
+ * every entered thread is reported as its scheduling latency. Threads started by a placed thread
+ * inherit its CPUs, so OpenCV's workers are started beforehand. Pinning and the counters are available
+ * on Linux, pinning and priority on Windows
+ */
+class ThreadPlacement {
+public:
+    ThreadPlacement() = default;
+
+    ThreadPlacement(const ThreadPlacement&) = delete;
+    ThreadPlacement& operator=(const ThreadPlacement&) = delete;
+
+    /**
+     * @brief Set the CPUs of a thread role
+     * @param spec ROLE=CPUS, with CPUS a comma-separated list of CPUs and ranges, e.g. detect=2-5,8
+     * @return true if the spec was valid
+     */
+    bool add_pin(const std::string& spec);
+
+    /**
+     * @brief Set the real-time priority of the capture thread
+     * @param priority SCHED_FIFO priority, 1-99 on Linux, 0 for the default policy
+     */
+    void set_capture_priority(int priority);
+
+    /**
+     * @brief Check if any pinning or priority is configured
+     * @return true if threads are placed, false if they only report their scheduling
+     */
+    bool is_configured() const;
+
+    /**
+     * @brief Check if threads of a role are placed
+     * @param role Thread role: capture, detect, render, or display
+     * @return true if the role is pinned, or is capture with a real-time priority
+     */
+    bool places(const std::string& role) const;
+
+    /**
+     * @brief Start OpenCV's worker threads on the calling thread, call before any thread enters a role
+     */
+    static void start_library_threads();
+
+    /**
+     * @brief Place the calling thread for its role and track its scheduling, call once at the start of the thread
+     * @param role Thread role: capture, detect, render, or display
+     */
+    void enter(const std::string& role);
+
+    /**
+     * @brief Print the CPUs and NUMA nodes of every pinned role, warn when capture and detection are on different nodes
+     */
+    void print_plan() const;
+
+    /**
+     * @brief Print the scheduling counters of every entered thread
+     */
+    void report() const;
+
+    /**
+     * @brief Get the scheduling counters of every entered thread, live threads are sampled now
+     * @return One entry per entered thread, in the order they entered
+     */
+    std::vector<ThreadSchedStats> get_sched_stats() const;
+
+    /**
+     * @brief Get the NUMA node of a CPU
+     * @param cpu CPU index
+     * @return Node index, -1 if unknown
+     */
+    static int cpu_node(int cpu);
+
+private:
+    /**
+     * @brief Kernel counters of a thread at one point in time
+     */
+    struct Counters {
+        uint64_t run_ns = 0;
+        uint64_t wait_ns = 0;
+        uint64_t slices = 0;
+        uint64_t preempted = 0;
+        bool valid = false;
+    };
+
+    /**
+     * @brief Entered thread, shared with the thread so it can record its final counters on exit
+     */
+    struct Tracked {
+        std::mutex mutex;
+        ThreadSchedStats stats;
+        Counters start;             // Counters when the thread entered its role
+        long tid = 0;               // Kernel thread id
+        bool finished = false;      // stats hold the final counters
+    };
+
+    /**
+     * @brief Pin the calling thread to a set of CPUs
+     * @param cpus CPU indices
+     * @return true if the thread was pinned
+     */
+    static bool pin(const std::vector<int>& cpus);
+
+    /**
+     * @brief Switch the calling thread to SCHED_FIFO
+     * @param priority Real-time priority
+     * @return true if the policy was applied
+     */
+    static bool make_realtime(int priority);
+
+    /**
+     * @brief Get the kernel id of the calling thread
+     * @return Thread id, 0 if unknown
+     */
+    static long current_tid();
+
+    /**
+     * @brief Read the kernel counters of a thread of this process
+     * @param tid Kernel thread id
+     * @return Counters, not valid if they could not be read
+     */
+    static Counters read_counters(long tid);
+
+    /**
+     * @brief Store the counters since the thread entered its role
+     * @param tracked Entered thread, its mutex held
+     * @param now Current counters
+     */
+    static void update(Tracked& tracked, const Counters& now);
+
+    std::map<std::string, std::vector<int>> cpus_;      // CPUs per role
+    int capture_priority_ = 0;
+
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<Tracked>> threads_;
+    bool warned_realtime_ = false;
+};
@@ -0,0 +1,69 @@
+#include "undistorter.hpp"
+
+#include <algorithm>
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+
+constexpr int BAND_HEIGHT = 64;   // Rows per remap band, small enough to balance across threads
+
+
+/**
+ * @brief Construct an Undistorter and build its maps
+ *
+ * The maps are computed once with initUndistortRectifyMap, per-frame undistortion is a remap only
+ * @param K Camera intrinsic matrix
+ * @param dist Camera distortion coefficients
+ * @param image_size Size of the frames to undistort
+ * @param alpha Free scaling, 0 keeps only valid pixels, 1 keeps all source pixels
+ */
+Undistorter::Undistorter(const cv::Mat& K, const cv::Mat& dist, const cv::Size& image_size, double alpha)
+    : image_size_(image_size)
+{
+    new_K_ = cv::getOptimalNewCameraMatrix(K, dist, image_size, alpha, image_size);
+    cv::initUndistortRectifyMap(K, dist, cv::Mat(), new_K_, image_size, CV_16SC2, map1_, map2_);
+}
+
+/**
+ * @brief Check if the maps are built
+ * @return true if frames can be undistorted
+ */
+bool Undistorter::is_ready() const {
+    return !map1_.empty();
+}
+
+/**
+ * @brief Undistort a frame
+ *
+ * Split the output into horizontal bands and remap the bands in parallel. The maps hold absolute
+ * source coordinates, so every band reads the source frame directly
+ * @param src Distorted input frame of the calibrated size
+ * @param dst Output undistorted frame of the calibrated size
+ */
+void Undistorter::apply(const cv::Mat& src, cv::Mat& dst) const {
+    dst.create(image_size_, src.type());
+    if (image_size_.empty()) {
+        return;
+    }
+
+    int num_bands = (image_size_.height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    cv::parallel_for_(cv::Range(0, num_bands), [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; ++b) {
+            int y0 = b * BAND_HEIGHT;
+            int rows = std::min(BAND_HEIGHT, image_size_.height - y0);
+            cv::Rect band(0, y0, image_size_.width, rows);
+            cv::Mat dst_band = dst(band);
+            cv::remap(src, dst_band, map1_(band), map2_(band), cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+        }
+    });
+}
+
+/**
+ * @brief Get the camera matrix of the undistorted output
+ * @return 3x3 camera matrix, distortion free
+ */
+cv::Mat Undistorter::get_camera_matrix() const {
+    return new_K_.clone();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+
+/**
+ * @class Undistorter
+ * @brief Undistort frames with precomputed fixed-point maps
+ *
+ * Build the undistortion maps once from the calibration, in the compact CV_16SC2 format,
+ * and remap every frame in horizontal bands across worker threads
+ */
+class Undistorter {
+public:
+    Undistorter() = default;
+
+    /**
+     * @brief Construct an Undistorter and build its maps
+     * @param K Camera intrinsic matrix
+     * @param dist Camera distortion coefficients
+     * @param image_size Size of the frames to undistort
+     * @param alpha Free scaling, 0 keeps only valid pixels, 1 keeps all source pixels
+     */
+    Undistorter(const cv::Mat& K, const cv::Mat& dist, const cv::Size& image_size, double alpha = 0.0);
+
+    /**
+     * @brief Check if the maps are built
+     * @return true if frames can be undistorted
+     */
+    bool is_ready() const;
+
+    /**
+     * @brief Undistort a frame
+     * @param src Distorted input frame of the calibrated size
+     * @param dst Output undistorted frame of the calibrated size
+     */
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+
+    /**
+     * @brief Get the camera matrix of the undistorted output
+     * @return 3x3 camera matrix, distortion free
+     */
+    cv::Mat get_camera_matrix() const;
+
+private:
+    cv::Size image_size_;
+    cv::Mat new_K_;      // Camera matrix of the undistorted image
+    cv::Mat map1_;       // Integer source coordinates, CV_16SC2
+    cv::Mat map2_;       // Interpolation table indices, CV_16UC1
+};
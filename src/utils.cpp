@@ -33,15 +33,33 @@ namespace Utils
  * the image is considered blurred. The threshold is lower for live camera input
  */
 bool is_blurred(const cv::Mat& gray, bool use_camera) {
+    return is_blurred(laplacian_variance(gray), use_camera);
+}
+
+/**
+ * @brief Check if a precomputed Laplacian variance indicates a blurred image
+ * @param variance Laplacian variance of the image, see laplacian_variance
+ * @param use_camera If true, use a lower threshold suitable for live camera input
+ * @return true if the image is considered blurred, false otherwise
+ */
+bool is_blurred(double variance, bool use_camera) {
+    // If use_camera is true, use a lower threshold for blur detection
+    double threshold = use_camera ? BLUR_THRESHOLD_CAMERA : BLUR_THRESHOLD;
+    return variance < threshold;
+}
+
+/**
+ * @brief Compute the variance of the Laplacian of an image, a sharpness score
+ * @param gray Grayscale image
+ * @return Laplacian variance, higher is sharper
+ */
+double laplacian_variance(const cv::Mat& gray) {
     cv::Mat lap;
     cv::Laplacian(gray, lap, CV_64F);
 
     cv::Scalar mean, stddev;
     cv::meanStdDev(lap, mean, stddev);
-
-    // If use_camera is true, use a lower threshold for blur detection
-    double threshold = use_camera ? BLUR_THRESHOLD_CAMERA : BLUR_THRESHOLD;
-    return (stddev[0] * stddev[0]) < threshold;
+    return stddev[0] * stddev[0];
 }
 
 /**
@@ -20,6 +20,21 @@ namespace Utils
      */
     bool is_blurred(const cv::Mat& gray, bool use_camera = false);
 
+    /**
+     * @brief Check if a precomputed Laplacian variance indicates a blurred image
+     * @param variance Laplacian variance of the image, see laplacian_variance
+     * @param use_camera If true, use a lower threshold suitable for live camera input
+     * @return true if the image is considered blurred, false otherwise
+     */
+    bool is_blurred(double variance, bool use_camera = false);
+
+    /**
+     * @brief Compute the variance of the Laplacian of an image, a sharpness score
+     * @param gray Grayscale image
+     * @return Laplacian variance, higher is sharper
+     */
+    double laplacian_variance(const cv::Mat& gray);
+
     /**
      * @brief Generate a filename with a timestamp, for example prefix_YYYYMMDD_HHMMSS.ext
      * @param prefix Prefix for the filename
@@ -0,0 +1,144 @@
+#include "video_recorder.hpp"
+
+#include <chrono>
+#include <iostream>
+
+
+constexpr int DRAIN_INTERVAL_MS = 2;      // Sleep of the encoder thread when the queue is empty
+
+
+/**
+ * @brief Construct a new VideoRecorder object and start the encoder thread
+ * @param path Output video file
+ * @param codec Four-character code of the codec, e.g. MJPG or FFV1
+ * @param fps Frame rate written to the file
+ * @param capacity Number of frames the queue can hold
+ */
+VideoRecorder::VideoRecorder(const std::string& path, const std::string& codec, double fps, size_t capacity)
+    : path_(path), fps_(fps), queue_(capacity), free_(capacity)
+{
+    std::string code = (codec + "    ").substr(0, 4);
+    fourcc_ = cv::VideoWriter::fourcc(code[0], code[1], code[2], code[3]);
+    worker_ = std::thread(&VideoRecorder::run, this);
+}
+
+/**
+ * @brief Encode the queued frames, stop the encoder thread, and close the file
+ */
+VideoRecorder::~VideoRecorder() {
+    close();
+}
+
+/**
+ * @brief Queue a copy of a frame for encoding, never blocks, to be called from a single thread
+ *
+ * The fullness check comes before the copy, so a dropped frame costs nothing
+ * @param frame 8-bit BGR frame
+ * @return true if the frame was queued, false if it was dropped
+ */
+bool VideoRecorder::record(const cv::Mat& frame) {
+    if (!running_.load(std::memory_order_relaxed) || frame.empty() || queue_.size() >= queue_.capacity()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    cv::Mat buffer;
+    free_.try_pop(buffer);
+    frame.copyTo(buffer);
+    if (!queue_.try_push(std::move(buffer))) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    recorded_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Encode all queued frames and stop the encoder thread, later frames are dropped
+ */
+void VideoRecorder::close() {
+    running_ = false;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    writer_.release();
+}
+
+/**
+ * @brief Get the number of frames queued for encoding
+ * @return Number of accepted frames
+ */
+uint64_t VideoRecorder::get_recorded() const {
+    return recorded_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the number of frames written to the file
+ * @return Number of encoded frames
+ */
+uint64_t VideoRecorder::get_written() const {
+    return written_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the number of frames dropped because the queue was full or the file could not be opened
+ * @return Number of dropped frames
+ */
+uint64_t VideoRecorder::get_dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the output file
+ * @return Path of the video file
+ */
+const std::string& VideoRecorder::get_path() const {
+    return path_;
+}
+
+/**
+ * @brief Encoder thread loop, drain the queue until stopped
+ *
+ * The file is opened on the first frame, with its size. Encoded buffers go back to the caller
+ * through the free queue, so steady-state recording does not allocate. The queue is drained
+ * completely before the thread exits
+ */
+void VideoRecorder::run() {
+    cv::Mat frame, resized;
+    bool failed = false;
+
+    while (true) {
+        bool stopping = !running_.load();
+
+        if (!queue_.try_pop(frame)) {
+            if (stopping) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+            continue;
+        }
+
+        if (!writer_.isOpened() && !failed) {
+            size_ = frame.size();
+            if (!writer_.open(path_, fourcc_, fps_, size_, frame.channels() == 3)) {
+                std::cerr << "Could not open video output " << path_ << ", frames are not recorded." << '\n';
+                failed = true;
+            }
+        }
+
+        if (failed) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (frame.size() != size_) {
+            cv::resize(frame, resized, size_, 0, 0, cv::INTER_AREA);
+            writer_.write(resized);
+            written_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            writer_.write(frame);
+            written_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        free_.try_push(std::move(frame));
+    }
+}
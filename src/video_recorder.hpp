@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+
+#include "spsc_queue.hpp"
+
+
+/**
+ * @class VideoRecorder
+ * @brief Record annotated frames to a video file on a background thread without blocking the caller
+ *
+ * Frames are copied into recycled buffers and passed through a bounded lock-free queue to an encoder
+ * thread. When the encoder falls behind and the queue is full, frames are dropped and counted instead
+ * of stalling capture, so memory stays bounded by twice the queue capacity. The file is opened with
+ * the size of the first frame; later frames of another size are resized to it
+ */
+class VideoRecorder {
+public:
+    /**
+     * @brief Construct a new VideoRecorder object and start the encoder thread
+     * @param path Output video file
+     * @param codec Four-character code of the codec, e.g. MJPG or FFV1
+     * @param fps Frame rate written to the file
+     * @param capacity Number of frames the queue can hold
+     */
+    VideoRecorder(const std::string& path, const std::string& codec = "MJPG", double fps = 30.0, size_t capacity = 8);
+
+    /**
+     * @brief Encode the queued frames, stop the encoder thread, and close the file
+     */
+    ~VideoRecorder();
+
+    VideoRecorder(const VideoRecorder&) = delete;
+    VideoRecorder& operator=(const VideoRecorder&) = delete;
+
+    /**
+     * @brief Queue a copy of a frame for encoding, never blocks, to be called from a single thread
+     * @param frame 8-bit BGR frame
+     * @return true if the frame was queued, false if it was dropped
+     */
+    bool record(const cv::Mat& frame);
+
+    /**
+     * @brief Encode all queued frames and stop the encoder thread, later frames are dropped
+     */
+    void close();
+
+    /**
+     * @brief Get the number of frames queued for encoding
+     * @return Number of accepted frames
+     */
+    uint64_t get_recorded() const;
+
+    /**
+     * @brief Get the number of frames written to the file
+     * @return Number of encoded frames
+     */
+    uint64_t get_written() const;
+
+    /**
+     * @brief Get the number of frames dropped because the queue was full or the file could not be opened
+     * @return Number of dropped frames
+     */
+    uint64_t get_dropped() const;
+
+    /**
+     * @brief Get the output file
+     * @return Path of the video file
+     */
+    const std::string& get_path() const;
+
+private:
+    /**
+     * @brief Encoder thread loop, drain the queue until stopped
+     */
+    void run();
+
+    std::string path_;
+    int fourcc_;
+    double fps_;
+    cv::VideoWriter writer_;
+    cv::Size size_;             // Frame size of the file, set by the first frame
+
+    SpscQueue<cv::Mat> queue_;  // Frames to encode, caller to encoder
+    SpscQueue<cv::Mat> free_;   // Encoded buffers returned for reuse, encoder to caller
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> recorded_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread worker_;
+};